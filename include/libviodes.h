@@ -19,6 +19,7 @@
 #include "viosymbol.h"
 #include "viotoken.h"
 #include "vioconsole.h"
+#include "violuapool.h"
 #include "viotypes.h"
 #include "vioregistry.h"
 #include "vioattrstyle.h"
@@ -14,6 +14,7 @@
 
 
 #include "viostyle.h"
+#include "violuapool.h"
 
 
 
@@ -83,8 +84,119 @@ protected:
  *****************************************************
  *****************************************************
 
+ A VioLogRecord is one message passed from faudes to
+ the console. The category is figured once by the
+ producer, so that consumers can filter without parsing
+ the text. Categories are bit flags to form filter masks.
+
+ *****************************************************
+ *****************************************************
+ */
+
+class VIODES_API VioLogRecord {
+
+public:
+  // categories
+  typedef enum { 
+    Plain=0x01,      // untagged output
+    Console=0x02,    // prompt, echo and console notes
+    LuaPrint=0x04,   // FAUDES_LUAPRINT
+    Progress=0x08,   // FAUDES_PROGRESS and loop callbacks
+    Warn=0x10,       // FAUDES_WARN
+    Exception=0x20,  // FAUDES_EXCEPTION
+    Debug=0x40,      // other FAUDES_ and DESTOOL_ tags
+    All=0x7f 
+  } Category;
+
+  // number of categories
+  static const int Count=7;
+
+  // classify raw faudes message
+  static Category Classify(const std::string& message, bool counted);
+
+  // map category to index 0 ... Count-1 and back
+  static int Index(Category cat);
+  static Category FromIndex(int idx);
+
+  // category name
+  static QString Name(Category cat);
+
+  // members
+  Category mCategory;
+  int mTime;          // ms since logger start
+  Qt::HANDLE mThread; // producing thread
+  QByteArray mText;   // payload, UTF-8
+  int mCntNow;        // loop callback progress (0 for none)
+  int mCntDone;       // loop callback total (0 for none)
+};
+
+
+/*
+ *****************************************************
+ *****************************************************
+
+ A VioLogRing is a bounded ring buffer of log records.
+ Any thread may append without locking; a single consumer
+ takes all pending records at once. When the ring is full, 
+ records are dropped and counted.
+
+ ******************************************************
+ ******************************************************
+ */
+
+class VIODES_API VioLogRing {
+
+public:
+  // construct/destruct (size is rounded up to a power of two)
+  VioLogRing(int size=4096);
+  ~VioLogRing(void);
+
+  // append record (any thread; false if dropped)
+  bool Push(VioLogRecord::Category cat, int time, const char* data, int len, int cntnow=0, int cntdone=0);
+
+  // take all pending records (consumer thread; returns count)
+  int Drain(QList<VioLogRecord>& rRecords);
+
+  // number of dropped records
+  int Dropped(void) const;
+
+private:
+  // cells with sequence number
+  struct Cell {
+    QAtomicInt mSeq;
+    VioLogRecord mRecord;
+  };
+  Cell* mCells;
+  int mMask;
+
+  // producer and consumer position
+  QAtomicInt mTail;
+  int mHead;
+
+  // dropped messages
+  QAtomicInt mDropped;
+
+  Q_DISABLE_COPY(VioLogRing)
+};
+
+
+/*
+ ******************************************************
+ ******************************************************
+
  The VioFaudesLogger is derievd from faudes::ConsoleOut
- to buffer all faudes console output. 
+ to buffer all faudes console output. Messages are 
+ classified and throttled on the calling thread and 
+ passed as records via a VioLogRing; a timer drains 
+ the ring and emits one notification per frame. Messages 
+ from the main ui thread are passed on immediately.
+
+ Throttling is per category: a minimum interval between
+ two messages and/or sampling of every n-th message. It
+ applies to captured messages only; the base class output,
+ i.e. std out or log file, receives all messages.
+ By default, progress is limited to one message per
+ second and debug output is not captured.
 
  ******************************************************
  ******************************************************
@@ -101,11 +213,26 @@ public:
   // explict destructor
   static void Destruct(void);
 
+  // number of messages dropped on overflow
+  int Dropped(void) const { return mRing.Dropped(); };
+
+  // configure throttling (interval in ms, 0 for none; keep every sample-th message)
+  void RateLimit(VioLogRecord::Category cat, int interval, int sample=1);
+
+  // configure categories to capture (mask)
+  void Capture(int mask) { mCapture=mask; };
+  int Capture(void) const { return mCapture; };
+
+  // number of messages suppressed by throttling
+  int Suppressed(VioLogRecord::Category cat) const;
+
+public slots:
+  // drain pending messages (main ui thread only)
+  void Flush(void);
+
 signals:
-  // notify new line
-  // tech: we emit the "Alt" version if we are not in the main ui thread
-  void NotifyAppend(QString message);
-  void NotifyAltAppend(QString message);
+  // notify new records
+  void NotifyRecords(const QList<VioLogRecord>& records);
 
 private:
   // construct/destruct
@@ -117,9 +244,28 @@ protected:
   // reimplement faudes dowrite
   void DoWrite(const std::string& message, long int cntnow, long int cntdone);
 
+  // throttle (any thread; true to pass)
+  bool DoThrottle(VioLogRecord::Category cat, int now);
+
   // single instance
   static VioFaudesLogger* mpVInstance;
 
+  // pending messages
+  VioLogRing mRing;
+  int mDroppedReported;
+  QTimer* mFlushTimer;
+
+  // time reference
+  QTime mClock;
+
+  // throttling per category
+  int mCapture;
+  int mInterval[VioLogRecord::Count];
+  int mSample[VioLogRecord::Count];
+  QAtomicInt mRecent[VioLogRecord::Count];
+  QAtomicInt mSeen[VioLogRecord::Count];
+  QAtomicInt mSuppressed[VioLogRecord::Count];
+
 };
 
 
@@ -145,6 +291,9 @@ public:
   VioConsoleHighlighter(QTextDocument *parent = 0);
   ~VioConsoleHighlighter(void) {};
 
+  // figure formats for one line (main ui thread only)
+  static void Ranges(const QString& text, QList<QTextLayout::FormatRange>& rRanges);
+
 protected:
   
   // highlight re-implementation 
@@ -157,17 +306,252 @@ private:
     QRegExp pattern;
     QTextCharFormat format;
   };
-  QVector<HighlightingRule> mHighlightingRules;
+  static QVector<HighlightingRule>* msRules;
+
+};
+
+
+/*
+ *****************************************************
+ *****************************************************
+
+ A VioLogStore holds console lines in an append-only
+ buffer. Lines are UTF-8 encoded and organized in chunks
+ of fixed line count, with one category byte per line
+ for filtering; optionally, full chunks are spilled
+ to a temporary file and accessed via memory mapping. 
+ Lines once completed do not change, so that readers in 
+ other threads may access them while the ui appends.
+
+ *****************************************************
+ *****************************************************
+ */
+
+class VIODES_API VioLogStore {
+
+public:
+  // construct/destruct
+  VioLogStore(void);
+  ~VioLogStore(void);
+
+  // append text (an incomplete last line is continued by the next append)
+  void Append(const QString& text, VioLogRecord::Category cat=VioLogRecord::Plain);
+
+  // number of lines (incl incomplete last line)
+  int Size(void) const;
+
+  // number of completed lines
+  int Completed(void) const;
+
+  // read lines (any thread)
+  QString Line(int pos) const;
+  void Lines(int first, int count, QStringList& rLines, QByteArray* pCategories=0) const;
+  void Categories(int first, int count, QByteArray& rCategories) const;
+
+  // clear all
+  void Clear(void);
+
+  // spill full chunks to temporary file
+  void Spill(bool on);
+  bool Spill(void) const { return mSpill; };
+
+private:
+  // lines per chunk
+  static const int msChunkLines=4096;
+
+  // chunk of lines
+  struct Chunk {
+    QVector<int> mOffsets;
+    QByteArray mCategories;
+    QByteArray mData;
+    uchar* mMap;
+    int mSize;
+  };
+  QList<Chunk*> mChunks;
+  int mLines;
+  QString mPartial;
+  char mPartialCategory;
+
+  // spill file
+  bool mSpill;
+  QTemporaryFile* mSpillFile;
+
+  // helpers (lock held)
+  void DoAppendLine(const QString& line, char cat);
+  void DoSpill(Chunk* chunk);
+  QString DoLine(int pos) const;
+  void DoCategories(int first, int count, QByteArray& rCategories) const;
+
+  // protect chunk list
+  mutable QMutex mMutex;
+
+  Q_DISABLE_COPY(VioLogStore)
+};
+
+
+/*
+ *****************************************************
+ *****************************************************
+
+ A VioLogSearch scans a VioLogStore for a literal
+ pattern in a separate thread, restricted to lines of the
+ specified categories. Only completed lines are scanned,
+ so a scan can be continued where it stopped. Matching 
+ line numbers are collected in ascending order and can 
+ be queried while the scan is in progress.
+
+ *****************************************************
+ *****************************************************
+ */
+
+class VIODES_API VioLogSearch : public QThread {
+
+Q_OBJECT
+
+public:
+  // construct/destruct
+  VioLogSearch(const VioLogStore* store, QObject* parent=0);
+  ~VioLogSearch(void);
+
+  // start scan (from 0 resets matches, otherwise continue)
+  void Start(const QString& pattern, Qt::CaseSensitivity cs, int from, int mask=VioLogRecord::All);
+
+  // stop scan and wait
+  void Cancel(void);
+
+  // access results
+  int Scanned(void) const;
+  int Count(void) const;
+  int Mask(void) const { return mMask; };
+
+  // nearest match after/before line (-1 for none; rFinal if this is definite)
+  int Match(int from, bool backward, bool& rFinal) const;
+
+signals:
+  // progress (lines scanned, matches so far)
+  void NotifyProgress(int scanned, int matches);
+
+private:
+  // start() thread calls run
+  void run(void);
+
+  // parameters
+  const VioLogStore* pStore;
+  QString mPattern;
+  Qt::CaseSensitivity mCase;
+  int mMask;
+  int mFrom;
+  int mTarget;
+  QAtomicInt mCancel;
+
+  // results
+  QVector<int> mMatches;
+  int mScanned;
+  mutable QMutex mMutex;
+};
+
+
+/*
+ *****************************************************
+ *****************************************************
+
+ A VioLogView displays a VioLogStore. Only the lines
+ in the visible window are layouted and highlighted, so
+ the scrollback is not limited by rendering cost. The
+ view follows the tail unless the user scrolled away.
+ A filter mask restricts the view to lines of given 
+ categories; rows are mapped to lines by an index that 
+ is extended incrementally.
+ Find runs a VioLogSearch in the background and jumps
+ to the match once it is known.
+
+ *****************************************************
+ *****************************************************
+ */
+
+class VIODES_API VioLogView : public QAbstractScrollArea {
+
+Q_OBJECT
+
+public:
+  // construct/destruct
+  VioLogView(QWidget* parent=0);
+  ~VioLogView(void);
+
+  // access store
+  VioLogStore* Store(void) { return &mStore; };
+
+  // selection
+  bool HasSelection(void) const { return mSelAnchor>=0; };
+
+  // filter by categories
+  void Filter(int mask);
+  int Filter(void) const { return mFilter; };
+
+public slots:
+  // append text
+  void Append(const QString& text, VioLogRecord::Category cat=VioLogRecord::Plain);
+
+  // clear all
+  void Clear(void);
+
+  // copy selected lines to clipboard
+  void Copy(void);
+
+  // find (flags as in VioConsoleWidget)
+  void Find(const QString& pattern, QTextDocument::FindFlags flags = 0);
+
+protected slots:
+  // search progress
+  void FindResolve(void);
+
+  // adjust scrollbars
+  void UpdateScrollBars(void);
 
-  // styles
-  QTextCharFormat mLabelFormat;
-  QTextCharFormat mRedFormat;
-  QTextCharFormat mPromptFormat;
+protected:
+  // map rows to lines
+  int Rows(void) const;
+  int RowToLine(int row) const;
+  int LineToRow(int line) const;
+  void UpdateRows(void);
+
+  // line geometry
+  int LineHeight(void) const;
+  int VisibleLines(void) const;
+  int LineAt(int y) const;
+
+  // reimplement
+  void paintEvent(QPaintEvent* event);
+  void resizeEvent(QResizeEvent* event);
+  void mousePressEvent(QMouseEvent* event);
+  void mouseMoveEvent(QMouseEvent* event);
+  void keyPressEvent(QKeyEvent* event);
+
+  // my data
+  VioLogStore mStore;
+  int mMaxWidth;
+
+  // filter
+  int mFilter;
+  QVector<int> mRows;
+  int mRowsScanned;
 
+  // selection
+  int mSelAnchor;
+  int mSelCurrent;
 
+  // find
+  VioLogSearch* mSearch;
+  QString mFindPattern;
+  Qt::CaseSensitivity mFindCase;
+  int mFindFrom;
+  int mFindDirection;
 };
 
 
+// forward
+class VioConsoleEvaluate;
+
 /*
  *****************************************************
  *****************************************************
@@ -175,6 +559,10 @@ private:
  A VioConsoleWidget is a widget that display faudes
  console output. It uses the faudes ConsoleOut Hook
  to grab all output generated by faudes functions.
+ In paged mode (default), output is kept in a VioLogView
+ with unlimited scrollback and the text edit is reduced
+ to the prompt. The context menu of the log view filters
+ output by category.
  
  *****************************************************
  *****************************************************
@@ -192,12 +580,25 @@ public:
 
   // configure
   void BufferSize(int max);
+  void Paged(bool on);
+  bool Paged(void) const { return mPaged; };
+  void Spill(bool on);
+
+  // filter by categories (VioLogRecord bit mask)
+  void Filter(int mask);
+  int Filter(void) const { return mFilter; };
 
 
 public slots:
 
   // append faudes console message
-  void AppendFaudes(QString message);
+  void AppendFaudes(QString message, VioLogRecord::Category cat=VioLogRecord::Plain);
+
+  // append records from logger
+  void AppendRecords(const QList<VioLogRecord>& records);
+
+  // evaluation done
+  void EvaluateDone(QString err);
 
   // clear all
   void Clear(void);
@@ -215,6 +616,10 @@ public slots:
   void FindAgain(void);
   void FindDialog(void);
 
+protected slots:
+
+  // context menu: filter by category
+  void FilterMenu(const QPoint& pos);
 
 protected:
 
@@ -230,9 +635,17 @@ protected:
   QList<QString> mHistory;
   int mHistoryCurrent;
 
+  // pending evaluation
+  VioConsoleEvaluate* mpEvaluate;
+
   // actual console
   QPlainTextEdit* mConsoleText;
 
+  // paged output
+  VioLogView* mLogView;
+  bool mPaged;
+  int mFilter;
+
   // overall Layout
   QVBoxLayout* mVbox;
 
@@ -252,13 +665,50 @@ protected:
 
 
 
+/*
+ ************************************************
+ ************************************************
+
+ A VioProgressDialog is a non-modal progress dialog
+ that tracks progress records from the VioFaudesLogger.
+ It shows up only for longer evaluations; the label is
+ extended by the most recent progress message and loop 
+ callback counts set the range.
+
+ ************************************************
+ ************************************************
+ */
+
+class VIODES_API VioProgressDialog : public QProgressDialog {
+
+  Q_OBJECT
+
+public:
+
+  // construct
+  VioProgressDialog(const QString& label, QWidget* parent=0);
+
+public slots:
+  // track logger records
+  void Records(const QList<VioLogRecord>& records);
+
+protected:
+  // my base label
+  QString mLabel;
+
+};
+
+
 /*
  ************************************************
  ************************************************
 
  The VioConsoleEvaluate class provides evaluation
- of a console command in a thread to keep the 
- main event loop alive. 
+ of a console command by a VioLuaPool worker to keep
+ the main event loop alive. The command operates on
+ the global lua state, i.e. the console session.
+ Start() returns immediately, completion is reported
+ by NotifyDone().
 
  ************************************************
  ************************************************
@@ -266,31 +716,50 @@ protected:
 
 
 // class definition
-class VioConsoleEvaluate : public QThread  {
+class VioConsoleEvaluate : public VioLuaJob  {
 
   Q_OBJECT
 
 public:
 
   // construct/destruct
-  VioConsoleEvaluate(QString command);
+  VioConsoleEvaluate(QString command, QObject* parent=0);
   ~VioConsoleEvaluate(void);
 
+  // start evaluation, call from application
+  void Start(void);
+
+  // result
+  const QString& ErrString(void) const { return mErrStr; };
+
+  // reimplement job: operate on global state
+  virtual bool Global(void) const { return true; };
 
 public slots:
-  // execute, call from application
-  QString Execute(void);
+  // request break
+  void Cancel(void);
 
+signals:
+  // evaluation done (empty string on success)
+  void NotifyDone(QString err);
 
+private slots:
+  // job finished
+  void Done(void);
+
+protected:
+  // reimplement job: evaluate (worker thread)
+  virtual void Run(faudes::LuaState* pL);
 
 private:
-  // start() thread calls run
-  void run(void);
 
   // operation reference
   QString mCommand;  
   QString mErrStr;  
 
+  // progress
+  VioProgressDialog* mProgress;
+
 };
 
 
@@ -0,0 +1,274 @@
+/* violuapool.h  - pool of lua interpreter threads */
+
+
+/*
+   Graphical IO for FAU Discrete Event Systems Library (libfaudes)
+
+   Copyright (C) 2010 Thomas Moor
+
+*/
+
+
+#ifndef FAUDES_VIOLUAPOOL_H
+#define FAUDES_VIOLUAPOOL_H
+
+
+#include "viostyle.h"
+
+
+// forward
+class VioLuaPool;
+class VioLuaWorker;
+
+
+/*
+ ************************************************
+ ************************************************
+
+ A VioLuaJob is a unit of lua evaluation to be run
+ by a VioLuaPool worker. Derived classes implement
+ Run(), which is called from the worker thread with
+ the lua state to operate on. By default, this is the
+ workers own state, which is reset to the globals
+ found after start-up when the job is done. Jobs that
+ reimplement Global() to return true operate on the
+ global lua state, i.e. the console session; they are
+ run one after the other by a dedicated worker.
+ Completion is reported by finished(), which is
+ delivered in the thread the job lives in. Derived
+ classes must Withdraw() on destruction. Each job
+ carries its own VioCancelContext, which the worker
+ binds to its thread while the job runs; thus,
+ Cancel() breaks this job only.
+
+ ************************************************
+ ************************************************
+ */
+
+class VIODES_API VioLuaJob : public QObject {
+
+  Q_OBJECT
+
+public:
+
+  // construct/destruct
+  VioLuaJob(QObject* parent=0);
+  virtual ~VioLuaJob(void);
+
+  // queue for evaluation, returns immediately (callers thread)
+  void Submit(void);
+
+  // queued or running
+  bool Pending(void) const;
+
+  // take from queue, or wait until done (callers thread)
+  void Withdraw(void);
+
+  // take from queue if not yet running (ret 0 on success)
+  int Dequeue(void);
+
+  // operate on the global lua state (default false: workers state)
+  virtual bool Global(void) const { return false; };
+
+  // query break request
+  bool Canceled(void) const { return mContext.Canceled(); };
+
+public slots:
+
+  // request break (any thread)
+  virtual void Cancel(void);
+
+signals:
+
+  // job done (emitted by worker)
+  void finished(void);
+
+protected:
+
+  // evaluate (this is the worker thread)
+  virtual void Run(faudes::LuaState* pL)=0;
+
+private:
+
+  // pool has access
+  friend class VioLuaPool;
+  friend class VioLuaWorker;
+
+  // queued or running (guarded by pool)
+  bool mPending;
+
+  // my cancellation context
+  VioCancelContext mContext;
+
+};
+
+
+/*
+ ************************************************
+ ************************************************
+
+ A VioLuaWorker is a long lived thread that owns
+ a lua state with the faudes bindings loaded. On
+ start-up, it records the global environment and
+ restores it after each job, i.e., globals introduced
+ or overwritten by a script are dropped. This is a
+ shallow reset: tables that existed before, e.g. the
+ faudes module, are not restored by content. Should
+ the reset fail, the state is rebuilt from scratch.
+ The global worker operates on the global lua state 
+ instead, which is set up on start-up and never reset.
+
+ ************************************************
+ ************************************************
+ */
+
+class VioLuaWorker : public QThread {
+
+  Q_OBJECT
+
+public:
+
+  // construct/destruct
+  VioLuaWorker(VioLuaPool* pool, bool global=false);
+  ~VioLuaWorker(void);
+
+  // operates on global state
+  bool Global(void) const { return mGlobal; };
+
+protected:
+
+  // start() thread calls run
+  void run(void);
+
+private:
+
+  // set up lua state and record globals
+  void Open(void);
+
+  // restore globals (ret 0 on success)
+  int Restore(void);
+
+  // my pool
+  VioLuaPool* pPool;
+
+  // my state
+  faudes::LuaState* mpL;
+  bool mGlobal;
+
+  // serialise set-up of lua states
+  static QMutex msOpenMutex;
+
+};
+
+
+/*
+ ************************************************
+ ************************************************
+
+ The VioLuaPool is a singleton that holds a number
+ of VioLuaWorker threads and dispatches jobs to
+ them in order of submission. Jobs on the global lua
+ state are pinned to the global worker, which is
+ started once per session by Warmup(). Further
+ workers are started on demand, up to one per core,
+ when jobs are queued while all workers are busy.
+ Thus, the cost of setting up a lua state with faudes 
+ bindings is not paid per evaluation. Access to the 
+ global state from the ui thread must be guarded by
+ GlobalMutex(), which the global worker holds while
+ running a job. The pool shuts down when the 
+ application quits.
+
+ ************************************************
+ ************************************************
+ */
+
+class VIODES_API VioLuaPool : public QObject {
+
+  Q_OBJECT
+
+public:
+
+  // access singleton
+  static VioLuaPool* G(void);
+
+  // destruct singleton
+  static void Destruct(void);
+
+  // start global worker
+  void Warmup(void);
+
+  // number of workers
+  int Workers(void) const;
+
+  // guard global lua state
+  QMutex* GlobalMutex(void) { return &mGlobalMutex; };
+
+  // queue job (callers thread)
+  void Submit(VioLuaJob* job);
+
+  // take job from queue, or wait until done (callers thread)
+  void Withdraw(VioLuaJob* job);
+
+  // take job from queue if not yet running (ret 0 on success)
+  int Dequeue(VioLuaJob* job);
+
+  // query job
+  bool Pending(const VioLuaJob* job) const;
+
+  // registry of queued and running jobs
+  QList<VioLuaJob*> Jobs(void) const;
+  int Running(void) const;
+
+public slots:
+
+  // request break for all jobs
+  void CancelAll(void);
+
+  // stop all workers
+  void Shutdown(void);
+
+private:
+
+  // workers have access
+  friend class VioLuaWorker;
+
+  // construct/destruct
+  VioLuaPool(QObject* parent=0);
+  ~VioLuaPool(void);
+
+  // start one more worker (mutex held)
+  void DoStartWorker(void);
+
+  // worker: wait for next job (0 on shutdown)
+  VioLuaJob* Take(VioLuaWorker* worker);
+
+  // worker: report job done
+  void Finish(VioLuaJob* job);
+
+  // singleton
+  static VioLuaPool* mpVInstance;
+
+  // workers
+  QList<VioLuaWorker*> mWorkers;
+  VioLuaWorker* mpGlobal;
+  int mMaxWorkers;
+  int mIdle;
+
+  // job queues
+  mutable QMutex mMutex;
+  QWaitCondition mQueued;
+  QWaitCondition mGlobalQueued;
+  QWaitCondition mFinished;
+  QQueue<VioLuaJob*> mQueue;
+  QQueue<VioLuaJob*> mGlobalQueue;
+  QList<VioLuaJob*> mRunning;
+  bool mShutdown;
+
+  // guard global state
+  QMutex mGlobalMutex;
+
+};
+
+
+#endif
@@ -26,7 +26,10 @@
 
  VioNameSetData holds static data required
  for the widget representations of a name set, i.e.
- a qlist of names.
+ the user order of elements by faudes index. For
+ copy and paste, the data converts to a binary mime
+ format with the ordered indices and one symbol table
+ block; plain text is provided for other applications.
  
  ************************************************
  ************************************************
@@ -51,9 +54,10 @@ public:
   virtual QMimeData* ToMime(void);
   virtual int FromMime(const QMimeData* pMime);
   virtual int TestMime(const QMimeData* pMime);
+  static QString MimeType(void);
 
-  // public data
-  QList<QString> mList;
+  // public data: user order by faudes index
+  QVector<faudes::Idx> mList;
 
 protected:
 
@@ -69,6 +73,72 @@ protected:
 };
 
 
+/*
+ ************************************************
+ ************************************************
+
+ A VioNameSetOperation computes a set operation
+ in a separate thread. Operands are sorted index 
+ arrays, taken by the VioNameSetModel as a snapshot
+ on the callers thread; the thread itself does not 
+ touch any faudes object. Symbolic names are taken
+ from a shallow copy of the models name cache; indices
+ not found there are reported for the model to resolve
+ and restart. The result is a sorted index array to
+ be applied by the model, plus the indices removed
+ and added.
+
+ ************************************************
+ ************************************************
+ */
+
+class VIODES_API VioNameSetOperation : public QThread {
+
+Q_OBJECT
+
+public:
+
+  // operators
+  typedef enum { Union, Intersection, Difference, FilterRegExp, FilterFlags } Operator;
+
+  // construct/destruct
+  VioNameSetOperation(QObject* parent, Operator op);
+  ~VioNameSetOperation(void);
+
+  // operator
+  Operator mOperator;
+
+  // operands: model elements, other set, names and flags of model elements
+  QVector<faudes::Idx> mArgA;
+  QVector<faudes::Idx> mArgB;
+  QHash<faudes::Idx,QString> mNames;
+  QVector<faudes::fType> mFlagsA;
+  QRegExp mRegExp;
+  faudes::fType mMask;
+  faudes::fType mValue;
+
+  // other set incl attributes, in the models symbol table (we own it)
+  faudes::NameSet* mOperand;
+
+  // model data revision at snapshot
+  int mRevision;
+
+  // result (sorted), removed and added elements
+  QVector<faudes::Idx> mResult;
+  QVector<faudes::Idx> mRemoved;
+  QVector<faudes::Idx> mAdded;
+
+  // elements with unknown name
+  QVector<faudes::Idx> mMissing;
+
+protected:
+
+  // start() thread calls run
+  void run(void);
+};
+
+
+
 /*
  ************************************************
  ************************************************
@@ -117,15 +187,29 @@ public:
   faudes::Idx Index(const QString& name) const;
   VioElement Element(const QString& name) const;
   QString SymbolicName(faudes::Idx idx) const;
-  const QString& At(int pos) const;
+  QString At(int pos) const;
   bool At(int pos, const QString& name);
   bool ReName(const QString& oldname, const QString& newname);
   bool Append(const QString& name);
   bool Insert(int pos, const QString& name);
   bool Remove(const QString& name);
   bool  RemoveAt(int pos);
+  bool InsertList(int pos, const QStringList& names);
+  bool RemoveList(const QStringList& names);
+  bool RemoveRange(int pos, int count);
   bool Move(int from, int to);
+  bool AssignSet(const faudes::NameSet& rSet);
+  bool MergeSet(const faudes::NameSet& rSet);
+  bool SubtractSet(const faudes::NameSet& rSet);
+
+  // set algebra in a separate thread, applied as one edit (ret 0 on started)
+  int SetOperation(VioNameSetOperation::Operator op, const faudes::NameSet& rSet);
+  int FilterOperation(const QRegExp& rRegExp);
+  int FilterOperation(faudes::fType mask, faudes::fType value);
+  bool OperationPending(void) const { return mpOperation!=0; };
+  void OperationWait(void);
   int IndexOf(const QString& name) const;
+  int IndexOf(faudes::Idx idx) const;
   bool Exists(const QString& name) const;
   QString UniqueSymbol(const QString& name="");
   void SortAscending(void);
@@ -164,6 +248,9 @@ signals:
   void NotifySymbolChange(QString name);  
   void NotifyChange(void);
 
+  // set operation applied
+  void NotifyOperationDone(bool changed);
+
 protected:
 
   // typed version of faudes object
@@ -191,18 +278,38 @@ protected:
 
   // my representation data
   VioNameSetData* mpNameSetData;  
-  QMap<QString,int> mRowMap;
-  void  DoFixRowMap(void);
+
+  // row map: positions are valid up to mRowMapFixed, fixed lazily
+  mutable QHash<faudes::Idx,int> mRowMap;
+  mutable int mRowMapFixed;
+  void  DoFixRowMap(int from=0) const;
   void  DoFixList(void);
+  void  DoSort(bool descending);
+
+  // bulk edit helpers (one pass, no notification, return true on changes)
+  bool  DoRemoveSet(const QSet<faudes::Idx>& rRemove);
+  bool  DoMergeSet(const faudes::NameSet& rSet, bool attr);
+  bool  DoContains(const faudes::NameSet& rSet, faudes::Idx idx) const;
+
+  // display name cache (shared by all views on this model)
+  mutable QHash<faudes::Idx,QString> mNameCache;
 
   // default layout
   VioNameSetLayout* mUserLayout;
 
+  // pending set operation
+  VioNameSetOperation* mpOperation;
+  void DoOperationStart(VioNameSetOperation* op);
+  bool DoOperationApply(const VioNameSetOperation* op);
+
 
 protected slots:
 
   // update faudes set from internal list model
   void DoFaudesUpdate(void);
+
+  // set operation thread finished
+  void DoOperationDone(void);
 };
 
 
@@ -275,6 +382,9 @@ public:
   VioData* SelectionData(void);
   void DeleteSelection(void);
 
+  // reimplement vioview: binary name set format plus text
+  QStringList MimeFormats(void) const;
+
 public slots:
 
   // show/hile property view
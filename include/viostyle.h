@@ -92,6 +92,45 @@ typedef enum {
 // forward
 class VioModel;
 
+
+/*
+ ************************************************
+ ************************************************
+
+ A VioCancelContext is a cancellation token for one
+ computation. While a context is bound to a thread
+ via VioStyle::FaudesBreakContext(), the faudes loop
+ callback of that thread reports a break if and only
+ if the context has been canceled. Threads without
+ a context fall back to the global break flag.
+
+ ************************************************
+ ************************************************
+ */
+
+class VIODES_API VioCancelContext {
+
+public:
+
+  // construct
+  VioCancelContext(void) : mCanceled(0) {};
+
+  // request break (any thread)
+  void Cancel(void) { mCanceled.fetchAndStoreOrdered(1); };
+
+  // clear request
+  void Reset(void) { mCanceled.fetchAndStoreOrdered(0); };
+
+  // query
+  bool Canceled(void) const { return mCanceled!=0; };
+
+private:
+
+  // flag
+  QAtomicInt mCanceled;
+
+};
+
 /*
  ************************************************
  ************************************************
@@ -180,10 +219,14 @@ public:
   static const QString& ConfigName(void) { return mConfigName; };
 
 
-  // faudes break flag
+  // faudes break flag (threads without context)
   static void FaudesBreakSet(void);
   static void FaudesBreakClr(void);
 
+  // faudes break context of the current thread (0 to unbind)
+  static void FaudesBreakContext(VioCancelContext* context);
+  static VioCancelContext* FaudesBreakContext(void);
+
   // viodes: configuration variant for derived classes
   QString FaudesType(void) const;
   bool UserAccess(void) const;
@@ -233,6 +276,7 @@ public:
   static QString DispEventName(const fGenerator* gen, faudes::Idx idx);
   static QString DispEventName(const faudes::EventSet* set, faudes::Idx idx);
   static QString SortName(const QString& str);
+  static int SortKey(const ushort* src, int len, ushort* dst); // dst capacity 2*len+1
   static QString SortStateName(const fGenerator* gen, faudes::Idx idx);
   static QString SortEventName(const fGenerator* gen, faudes::Idx idx); 
   static QString SortEventName(const faudes::EventSet* set, faudes::Idx idx); 
@@ -535,4 +579,57 @@ class VIODES_API VioCheckBox : public QCheckBox {
 };
 
 
+/*
+ *****************************************************
+ *****************************************************
+
+ helper: persistent stack for section nesting in
+ highlighters; copies share all entries, push and pop
+ create a new top without touching other copies. Each
+ entry carries an accumulated hash for state comparison.
+
+ *****************************************************
+ *****************************************************
+ */
+
+template<class T> class VioSectionStack {
+
+  public:
+
+  // construct
+  VioSectionStack(void) {};
+
+  // access
+  bool Empty(void) const { return !mTop; };
+  int Size(void) const { return mTop ? mTop->mSize : 0; };
+  const T& Top(void) const { return mTop->mItem; };
+  uint Hash(void) const { return mTop ? mTop->mHash : 0; };
+
+  // edit
+  void Push(const T& item, uint hash=0) { 
+    Node* node = new Node();
+    node->mItem=item;
+    node->mNext=mTop;
+    node->mSize=Size()+1;
+    node->mHash=Hash()*31+hash+1;
+    mTop=QExplicitlySharedDataPointer<Node>(node);
+  };
+  void Pop(void) { if(mTop) mTop=mTop->mNext; };
+  void Clear(void) { mTop=QExplicitlySharedDataPointer<Node>(); };
+
+ private:
+
+  // node
+  class Node : public QSharedData {
+  public:
+    T mItem;
+    QExplicitlySharedDataPointer<Node> mNext;
+    int mSize;
+    uint mHash;
+  };
+  QExplicitlySharedDataPointer<Node> mTop;
+
+};
+
+
 #endif
@@ -68,12 +68,145 @@ protected:
 
 
 
+/*
+ *****************************************************
+ *****************************************************
+
+ A VioSymbolWorld is a sorted list of known symbols,
+ provided as QStringListModel for completers, with a
+ lookup index to test whether a string is a known
+ symbol or a prefix thereof. The symbols are either set
+ explicitly or tracked incrementally from a source item
+ model.
+
+ For large alphabets, the world provides a search for
+ substring and fuzzy matches. It is based on an index
+ of character trigrams, which is built on the first
+ query and maintained incrementally thereafter.
+ Matches are ranked exact, prefix, substring,
+ subsequence, and trigram overlap.
+
+ Symbol worlds may be shared: the static Acquire()
+ returns the world registered under the specified key,
+ e.g. generator and element type, and increments its
+ reference count. Release() decrements the count and
+ deletes the world when the last user has detached.
+ Thus, the world is updated once per change, no matter
+ how many completers are attached.
+
+ *****************************************************
+ *****************************************************
+ */
+
+
+class VIODES_API VioSymbolWorld : public QObject {
+
+Q_OBJECT
+
+public:
+
+  // construct/destruct (private world, not registered)
+  VioSymbolWorld(QObject* parent=0);
+  ~VioSymbolWorld(void);
+
+  // shared worlds: attach/detach by key
+  static VioSymbolWorld* Acquire(const QString& rKey);
+  static void Release(VioSymbolWorld* pWorld);
+
+  // shared worlds: construct key from owner and element type
+  static QString Key(const void* pOwner, const QString& rType);
+
+  // alternative setting for source
+  void setSymbols(const QStringList& rStringList);
+  void setSource(QAbstractItemModel* pStringModel, int col=0);
+  QAbstractItemModel* source(void) const { return pSymbolSource; };
+
+  // my known symbols as model
+  QStringListModel* Model(void) { return mSymbolWorld; };
+
+  // sync with source model (full copy unless tracked)
+  void Update(void);
+
+  // fast lookup: symbol is known
+  bool isKnownSymbol(const QString& rSymbol) const { return mSymbolCount.contains(rSymbol); };
+
+  // fast lookup: symbol is a prefix of some known symbol
+  bool isSymbolPrefix(const QString& rPrefix) const;
+
+  // search: top k matches, ranked (case insensitive)
+  QStringList Search(const QString& rQuery, int k=20) const;
+
+public slots:
+
+  // release mem
+  void Clear(void);
+
+protected slots:
+
+  // track source model
+  void SourceRowsInserted(const QModelIndex& parent, int first, int last);
+  void SourceRowsRemoved(const QModelIndex& parent, int first, int last);
+  void SourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight);
+  void SourceReset(void);
+
+protected:
+
+  // helpers to maintain my sorted world
+  QString SourceSymbol(int row) const;
+  void SetSymbols(const QStringList& rSymbols);
+  int SymbolPosition(const QString& rSymbol) const;
+  void InsertSymbol(const QString& rSymbol);
+  void RemoveSymbol(const QString& rSymbol);
+
+  // helpers to maintain the search index
+  void SearchIndexBuild(void) const;
+  void SearchIndexInsert(const QString& rSymbol) const;
+  void SearchIndexRemove(const QString& rSymbol) const;
+
+  // my known symbols (sorted, unique)
+  QStringListModel* mSymbolWorld; 
+
+  // lookup index: multiplicity of each known symbol
+  QHash<QString,int> mSymbolCount;
+
+  // source model and per row symbols as seen by us
+  QAbstractItemModel* pSymbolSource;
+  int mSymbolSourceColumn;
+  QStringList mSourceSymbols;
+  bool mSourceSynced;
+
+  // search index: symbols and lower case keys by id, trigram posting lists
+  mutable bool mSearchValid;
+  mutable QVector<QString> mSearchSymbols;
+  mutable QVector<QString> mSearchKeys;
+  mutable QHash<QString,int> mSearchIds;
+  mutable QHash<quint64, QVector<int> > mSearchGrams;
+  mutable int mSearchHoles;
+
+  // search scratch buffer: trigram hits by id (all zero between searches)
+  mutable QVector<int> mSearchHits;
+
+  // shared worlds: key and reference count
+  QString mKey;
+  int mRefCount;
+
+  // shared worlds: registry
+  static QHash<QString,VioSymbolWorld*>* msRegistry;
+};
+
+
 /*
  *****************************************************
  *****************************************************
 
  A VioSymbolCompleter is a completer that completes
- symboly wrt a given symboltable or faudes set
+ symboly wrt a given symboltable or faudes set. The
+ symbols are held by a VioSymbolWorld, which is either
+ private to the completer or shared by key. In search
+ mode, the completer pops up the top ranked substring
+ or fuzzy matches rather than inline prefix completion;
+ the search is run on the textEdited() signal of the
+ editor, which is connected by VioSymbolEdit.
 
  *****************************************************
  *****************************************************
@@ -94,24 +227,52 @@ public:
   void setSymbolWorld(const QStringList& rStringList);
   void setSymbolWorld(const faudes::EventSet& rEventSet);
   void setSymbolWorld(QAbstractItemModel* pStringModel, int col=0);
-  QStringListModel* symbolWorld(void) { return mSymbolWorld; };
+  void setSharedSymbolWorld(const QString& rKey);
+  void setSharedSymbolWorld(const QString& rKey, const QStringList& rStringList);
+  QStringListModel* symbolWorld(void) { return pWorld->Model(); };
 
-  // copy source model to own model
+  // sync with source model
   void Update(void);
 
+  // fast lookup: symbol is known
+  bool isKnownSymbol(const QString& rSymbol) const { return pWorld->isKnownSymbol(rSymbol); };
+
+  // fast lookup: symbol is a prefix of some known symbol
+  bool isSymbolPrefix(const QString& rPrefix) const { return pWorld->isSymbolPrefix(rPrefix); };
+
   // release mem
   void clrSymbolWorld(void);
 
+  // search mode: substring and fuzzy matches
+  void setSearchMode(bool on, int k=20);
+  bool searchMode(void) const { return mSearchMode; };
+
+  // reimplement qcompleter: search results match any path in search mode
+  QStringList splitPath(const QString& path) const;
+
+public slots:
+
+  // search mode: run search on user edits and pop up results
+  void SearchEdited(const QString& text);
+
 protected:
 
-  // my known symbols
-  QStringListModel* mSymbolWorld; 
+  // set model according to mode
+  void UpdateModel(void);
 
-  // source model
-  QAbstractItemModel* pSymbolSource;
-  int mSymbolSourceColumn;
+  // my private world
+  VioSymbolWorld* mOwnWorld; 
+
+  // world in use (private or shared)
+  VioSymbolWorld* pWorld; 
+
+  // search mode and results
+  bool mSearchMode;
+  int mSearchCount;
+  QStringListModel* mSearchResults;
 };
 
+
 /* 
  ******************************************
  ******************************************
@@ -295,6 +456,8 @@ Note: if setDimensions changes the column
 count, it will clear the model and reset any 
 delegate configuration eg completers. If it
 changes the row count, it wil clear the contents.
+Columns may attach to a shared symbol world by key,
+so that all tables with the same symbols use one list.
 
 THIS CLASS NEEDS A REDESIGN
 - use model/view
@@ -326,12 +489,14 @@ public:
   void setSymbolWorld(int col, const QStringList& rStringList=QStringList());
   void setSymbolWorld(int col, const faudes::NameSet& rNameSet);
   void setSymbolWorld(int col, QAbstractItemModel* pStringModel, int srccol);
+  void setSharedSymbolWorld(int col, const QString& rKey, const QStringList& rStringList=QStringList());
 
   // set base set (single clolumn convenience interface)
   void setSymbolWorld(QCompleter* completer);
   void setSymbolWorld(const QStringList& rStringList=QStringList());
   void setSymbolWorld(const faudes::NameSet& rNameSet);
   void setSymbolWorld(QAbstractItemModel* pStringModel, int srccol);
+  void setSharedSymbolWorld(const QString& rKey, const QStringList& rStringList=QStringList());
 
   // behaviour/apearance (implicitely set #cols)
   void setHeader(QStringList headers);
@@ -351,6 +516,8 @@ public:
   QStringList symbolColumn(int col) const;
   faudes::EventSet eventSetColumn(int col) const;
   void setEventSetColumn(int col, const faudes::EventSet& rEventSet);
+  void mergeEventSetColumn(int col, const faudes::EventSet& rEventSet);
+  void subtractEventSetColumn(int col, const faudes::EventSet& rEventSet);
   void columnToNameSet(int col, faudes::NameSet& rNameSet) const; // for non-std symboltabel
 
   // set/get content columns (for single comlumn case)
@@ -401,6 +568,9 @@ protected:
   bool mEditing;
   bool mInsertMode;
 
+  // update column items in place
+  void DoSetColumn(int col, const QStringList& rStringList);
+
   // have my hooks
   void keyPressEvent(QKeyEvent *event);
   bool edit(const QModelIndex& index, EditTrigger trigger, QEvent* event);
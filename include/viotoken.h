@@ -60,22 +60,22 @@ private:
   QTextCharFormat mStringFormat;
   QTextCharFormat mBinaryFormat;
 
-  // section nesting 
-  QRegExp mTagExpression;
-
 public:
 
-  // nested section data 
+  // nested section data (position relative to block to survive edits elsewhere)
   class SectionInfo {
   public:
+    SectionInfo(void) : mOffset(0), mLength(0) {};
+    int Position(void) const { return mBlock.isValid() ? mBlock.position()+mOffset : -1; };
     QString mName;
-    int     mPosition;
+    QTextBlock mBlock;
+    int     mOffset;
     int     mLength;
   };
   class BlockData : public QTextBlockUserData {
   public:
     virtual ~BlockData(void) {};
-    QVector<SectionInfo> mSectionVector;
+    VioSectionStack<SectionInfo> mSectionStack; // shared with previous block
     SectionInfo mBeginTag;
     SectionInfo mEndTag;
   };
@@ -194,6 +194,12 @@ public:
   virtual void ExportFaudesFile(const QString& rFilename) const;
   virtual void ImportFaudesFile(const QString& rFilename);
 
+  // graphics export, format by suffix e.g. svg, pdf, png (ret 0 on success)
+  virtual int ExportGraphics(const QString& rFilename) const;
+
+  // automatic layout of graphical representation (ret 0 on success)
+  virtual int AutoLayout(void);
+
   // vio data access
   virtual VioData* Data(void);
   virtual int Data(const VioData* pData);
@@ -213,6 +219,17 @@ public:
   bool Modified(void) const;
   virtual void Modified(bool ch);
 
+  // revision count (incremented whenever the model is about to change)
+  int Revision(void) const;
+
+  // data revision count (as above, but excl selection changes)
+  int DataRevision(void) const;
+
+  // change journal: test whether edits are reported by NotifyJournal
+  virtual bool JournalSupported(void) const { return false; };
+
+  // change journal: replay a record as emitted by NotifyJournal (0 on success)
+  virtual int JournalReplay(const QByteArray& rRecord);
 
 
 public slots:
@@ -221,6 +238,9 @@ public slots:
   void ChildModified(bool ch);  
   void ParentModified(bool ch);
 
+  // announce upcomming change (emit notification, increment revision)
+  void AboutToChange(bool selection=false);
+
   // highlite/show request (default: emit request to pass on to all views)
   virtual void Highlite(const VioElement& elem, bool on=true);
   virtual void HighliteClear(void);
@@ -270,6 +290,14 @@ signals:
   // lazy views get a last chance here to save their data in the model
   void NotifyFlush(void);
 
+  // notify lazy clients (e.g. clipboard) that the model or its selection is about 
+  // to change; they get a last chance here to take a snapshot
+  void NotifyAboutToChange(void);
+
+  // notify journal (e.g. autosave) on an edit operation by a compact record; an
+  // empty record indicates a change that has not been journaled (e.g. paste, undo)
+  void NotifyJournal(const QByteArray& rRecord);
+
 protected:
 
   // allocate faudes object and visual model data
@@ -307,6 +335,10 @@ protected:
   // record user changes
   bool mModified;
 
+  // revision count
+  int mRevision;
+  int mDataRevision;
+
   // selection: list of elements
   QList<VioElement> mSelection;
 
@@ -375,6 +407,9 @@ public:
 
   // directed mime access (convenience wrapper using mime encoding provided by VioData)
   int TestMimeData(const QMimeData* pMimeData);
+
+  // mime formats provided by the encoding of SelectionData() 
+  virtual QStringList MimeFormats(void) const;
   int InsertMimeData(const QMimeData* pMimeData);
   QMimeData* SelectionMimeData(void);
 
@@ -475,6 +510,9 @@ protected:
   // record changes
   bool mModified;
 
+  // clipboard: defer copy until data is requested (requires model based selection)
+  bool mLazyCopy;
+
   // actions
   QList<QAction*> mFileActions;
   QList<QAction*> mEditActions;
@@ -494,6 +532,66 @@ protected:
 };
 
 
+/*
+ ************************************************
+ ************************************************
+
+ A VioLazyMimeData is used by VioView to pass data
+ to the clipboard. On copy, it only records a reference 
+ to the view and the current model revision. The actual 
+ VioData and its mime encoding are generated when the data 
+ is requested, e.g. by a paste in another widget or application. 
+ Should the model announce a change before, the VioData 
+ is extracted in due course. Once there is a VioData
+ snapshot, the model is no longer referenced. The formats
+ provided are reported by the view from the outset.
+
+ ************************************************
+ ************************************************
+ */
+
+
+class VIODES_API VioLazyMimeData : public QMimeData {
+
+Q_OBJECT
+
+public:
+  // construct/destruct
+  VioLazyMimeData(VioView* view);
+  virtual ~VioLazyMimeData(void);
+
+  // reimplement qmimedata: formats we (will) provide
+  virtual QStringList formats(void) const;
+  virtual bool hasFormat(const QString& mimetype) const;
+
+  // test whether we did extract the data
+  bool IsMaterialized(void) const;
+
+public slots:
+
+  // extract vio data from view now (ignore on stale revision)
+  void Materialize(void);
+
+protected:
+
+  // reimplement qmimedata: generate data on request
+  virtual QVariant retrieveData(const QString& mimetype, QVariant::Type type) const;
+
+  // source reference
+  QPointer<VioView> pView;
+  QPointer<VioModel> pModel;
+  int mRevision;
+
+  // formats provided
+  QStringList mFormats;
+
+  // snapshot and its encoding
+  VioData* mData;
+  QMimeData* mMimeData;
+
+};
+
+
 /*
  ************************************************
  ************************************************
@@ -572,6 +670,9 @@ public:
   bool Modified(void) const;
   virtual void Modified(bool ch);
 
+  // get data snapshot incl lazy view data (caller owns result)
+  VioData* Data(void);
+
 
 public slots:
 
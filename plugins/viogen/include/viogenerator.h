@@ -83,6 +83,69 @@ class VioGeneratorListModel;
 class VioGeneratorGraphModel;
 
 
+/*
+ ************************************************
+ ************************************************
+
+ VioStateIndexMap is used to pass on re-indexing of
+ states when generator data is merged, e.g. on paste. 
+ Source indicees typically form a contiguous range, 
+ so we use a flat table with an offset. We fall back 
+ to a hash for sparse ranges. Indicees not mapped 
+ explicitly are mapped to themselfs. 
+
+ ************************************************
+ ************************************************
+ */
+
+class VIOGEN_API VioStateIndexMap {
+
+public:
+
+  // construct/destruct
+  VioStateIndexMap(void);
+
+  // clear to identity
+  void Clear(void);
+
+  // prepare for source indicees min to max, count expected entries
+  void Reserve(faudes::Idx min, faudes::Idx max, int count);
+
+  // record a map entry
+  void Insert(faudes::Idx src, faudes::Idx dst);
+
+  // query (unmapped indicees map to themself)
+  faudes::Idx Map(faudes::Idx src) const {
+    if(mIdentity) return src;
+    if(src>=mOffset && src-mOffset < (faudes::Idx) mDense.size()) {
+      faudes::Idx dst=mDense.at(src-mOffset);
+      return dst!=0 ? dst : src;
+    }
+    if(mSparse.isEmpty()) return src;
+    return mSparse.value(src,src);
+  }
+
+  // apply in place
+  void Apply(faudes::Idx& rIdx) const { rIdx=Map(rIdx); }
+
+  // test for trivial map
+  bool IsIdentity(void) const { return mIdentity; }
+
+protected:
+
+  // flat table for the range [mOffset, mOffset+mDense.size()), 0 for unmapped
+  faudes::Idx mOffset;
+  QVector<faudes::Idx> mDense;
+
+  // fallback for indicees out of range 
+  QHash<faudes::Idx,faudes::Idx> mSparse;
+
+  // no non-trivial entries recorded so far
+  bool mIdentity;
+};
+
+
+
 /*
  ************************************************
  ************************************************
@@ -129,7 +192,7 @@ public:
   virtual void Clear(void);
 
   // state reindexing
-  virtual void ApplyStateIndicees(const QMap<faudes::Idx,faudes::Idx> & rNewIdx) {};
+  virtual void ApplyStateIndicees(const VioStateIndexMap& rNewIdx) { (void) rNewIdx; };
 
   // public access to static data (pre 0.47)
   QList<VioGeneratorAbstractData*> mDataList; 
@@ -186,7 +249,7 @@ public:
   virtual int  FromTokenReader(faudes::TokenReader& rTr) =0;
 
   // state reindeing
-  virtual void ApplyStateIndicees(const QMap<faudes::Idx,faudes::Idx> & rNewIdx)=0;
+  virtual void ApplyStateIndicees(const VioStateIndexMap& rNewIdx)=0;
 
   // static token constructor
   static VioGeneratorAbstractData* NewFromTokenReader(faudes::TokenReader& rTr);
@@ -250,6 +313,10 @@ public:
   // access to representation models
   const QList<VioGeneratorAbstractModel*> ModelList(void) { return mModelList; };
 
+  // key for shared symbol worlds of states and events
+  QString SymbolWorldKey(VioElement::EType etype) const 
+    { return VioSymbolWorld::Key(this,QString::number(etype)); };
+
   // set/get default layout
   const VioGeneratorLayout& Layout(void) { return *mpUserLayout; };
   void Layout(const VioGeneratorLayout& layout) { *mpUserLayout=layout; };
@@ -267,6 +334,17 @@ public:
   VioData* SelectionData(void);
   void DeleteSelection(void);
 
+  // reimplement viomodel: change journal
+  virtual bool JournalSupported(void) const { return true; };
+  virtual int JournalReplay(const QByteArray& rRecord);
+
+  // change journal: report a representation change not covered by records
+  void JournalAnyChange(void) { emit NotifyJournal(QByteArray()); };
+
+  // reimplement viomodel: graphics export and layout via graph representation
+  virtual int ExportGraphics(const QString& rFilename) const;
+  virtual int AutoLayout(void);
+
 
 
 public slots:  
@@ -382,6 +460,14 @@ protected:
   // data access: merge data
   virtual int DoMergeData(const VioData* pData);
 
+  // change journal: record operations (suppressed for nested edits)
+  typedef enum { JIns=1, JDel, JEdit, JName, JAttr } JournalOp;
+  int mJournalLevel;
+  void JournalRecord(JournalOp op, const VioElement& elem, 
+    const VioElement& delem=VioElement(), const QString& str="");
+  void JournalWrite(QDataStream& out, const VioElement& elem) const;
+  VioElement JournalRead(QDataStream& in);
+
 };
 
 
@@ -57,7 +57,7 @@ public:
   virtual int  FromTokenReader(faudes::TokenReader& rTr);
 
   // state reindexing
-  virtual void ApplyStateIndicees(const QMap<faudes::Idx,faudes::Idx> & rNewIdx);
+  virtual void ApplyStateIndicees(const VioStateIndexMap& rNewIdx);
 
   // clear to default (empty)
   virtual void Clear(void);
@@ -127,6 +127,9 @@ public:
 
 public slots:
 
+  // record each change of the graph scene
+  void ChildChange(void);
+
   // editing: the generator model notifies us on changes
   // performed on the faudes generator. In turn, we signal our views 
   // about changes in the faudes generator using signals inherited
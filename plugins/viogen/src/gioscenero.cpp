@@ -326,13 +326,14 @@ int GioSceneRo::JpgWrite(const QString &jpgfile) {
   if(jscale*width() > pGeneratorConfig->ExportMaxSize()) jscale = ((double) pGeneratorConfig->ExportMaxSize())/width();
   int jwidth  =  (int) (jscale*width());
   int jheight  = (int) (jscale*height());
-  QPixmap pixmap(jwidth,jheight);
-  pixmap.fill();
-  QPainter painter(&pixmap);
+  // render to image, since pixmaps require a display (batch mode)
+  QImage image(jwidth,jheight,QImage::Format_ARGB32_Premultiplied);
+  image.fill(0xffffffff);
+  QPainter painter(&image);
   painter.setRenderHint(QPainter::Antialiasing);
   render(&painter,QRectF(),itemsBoundingRect());
   painter.end();
-  bool ok=pixmap.save(jpgfile,"JPG");
+  bool ok=image.save(jpgfile,"JPG");
   return (ok ? 0 : 1);
 }
 
@@ -344,13 +345,14 @@ int GioSceneRo::PngWrite(const QString &pngfile) {
   if(jscale*width() > pGeneratorConfig->ExportMaxSize()) jscale = ((double) pGeneratorConfig->ExportMaxSize())/width();
   int jwidth  =  (int) (jscale*width());
   int jheight  = (int) (jscale*height());
-  QPixmap pixmap(jwidth,jheight);
-  pixmap.fill();
-  QPainter painter(&pixmap);
+  // render to image, since pixmaps require a display (batch mode)
+  QImage image(jwidth,jheight,QImage::Format_ARGB32_Premultiplied);
+  image.fill(0xffffffff);
+  QPainter painter(&image);
   painter.setRenderHint(QPainter::Antialiasing);
   render(&painter,QRectF(),itemsBoundingRect());
   painter.end();
-  bool ok=pixmap.save(pngfile,"PNG");
+  bool ok=image.save(pngfile,"PNG");
   return (ok ? 0 : 1);
 }
 
@@ -1277,6 +1279,8 @@ bool GioSceneRo::Modified(void) {
 // reset changes
 void GioSceneRo::Modified(bool ch) {
   FD_DQG("GioSceneRo::Modified("<<ch<<")");
+  // report each change
+  if(ch) emit NotifyChange();
   // set
   if(!mModified && ch) {
     mModified=true;
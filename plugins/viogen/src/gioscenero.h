@@ -128,6 +128,7 @@ signals:
 
   // notify user interaction (no such in readonly)
   void NotifyModified(bool);
+  void NotifyChange(void);
 
   // notify data match (incl UpdateNewModel from file io)
   void NotifyConsistent(bool);
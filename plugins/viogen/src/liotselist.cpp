@@ -35,6 +35,9 @@ LioVList::LioVList(VioGeneratorListModel* genlist) :
   // empty dimensions
   mDataColumns=0;
   mFlagColumns=0;
+  mFlagCompact=false;
+  mFlagGeneration=0;
+  mFlagRevision=-1;
   // update/resize hook
   mUpdateOldRows=-1;
   mUpdateChanged=false;
@@ -74,9 +77,60 @@ void LioVList::InsertFlags(const QList<VioBooleanProperty>& boolprops) {
     mFlagAddresses.append(i);
   }
   mFlagColumns=mFlagNames.size();
+  mFlagGeneration++;
   FD_DQG("LioVList::InsertFlags(#" << mFlagColumns << ")");
 }
 
+// flags as one compact column
+void LioVList::CompactFlags(bool on) {
+  if(mFlagCompact==on) return;
+  mFlagCompact=on;
+  reset();
+}
+
+// flag cache: decode the attribute once per row and generation
+quint64 LioVList::FlagWord(int row) const {
+  // model edits invalidate all rows (selection changes dont)
+  if(pVioGeneratorModel->DataRevision()!=mFlagRevision) {
+    mFlagRevision=pVioGeneratorModel->DataRevision();
+    mFlagGeneration++;
+  }
+  if(mFlagCache.size()!=rowCount()) {
+    mFlagCache.fill(0,rowCount());
+    mFlagCacheGen.fill(-1,rowCount());
+  }
+  if(mFlagCacheGen.at(row)==mFlagGeneration) return mFlagCache.at(row);
+  // decode
+  const VioElement& elem=pVioGeneratorListModel->At(row);
+  faudes::AttributeFlags* attr=pVioGeneratorModel->ElementAttr(elem);
+  const QList<VioBooleanProperty>& props= pVioGeneratorModel->ElementBooleanProperties(elem.Type());
+  quint64 word=0;
+  for(int flagno=0; flagno<mFlagColumns && flagno<64; flagno++) {
+    int prop=mFlagAddresses.at(flagno);
+    if(prop<0 || prop>=props.size()) continue;
+    if(props.at(prop).Test(attr->mFlags)) word |= ((quint64) 1) << flagno;
+  }
+  delete attr;
+  mFlagCache[row]=word;
+  mFlagCacheGen[row]=mFlagGeneration;
+  return word;
+}
+
+// flag cache: test one flag (beyond the word width we ask the model)
+bool LioVList::FlagTest(int row, int flagno) const {
+  if(flagno>=64) 
+    return pVioGeneratorModel->ElementBooleanProperty(pVioGeneratorListModel->At(row),mFlagAddresses.at(flagno));
+  return (FlagWord(row) >> flagno) & 1;
+}
+
+// flag cache: compact text
+QString LioVList::FlagText(int row) const {
+  QStringList res;
+  for(int flagno=0; flagno<mFlagColumns; flagno++) 
+    if(FlagTest(row,flagno)) res.append(mFlagNames.at(flagno));
+  return res.join(" ");
+}
+
 
 // tabelmodel: headers
 QVariant LioVList::headerData(int section, Qt::Orientation orientation, int role) const {
@@ -85,6 +139,8 @@ QVariant LioVList::headerData(int section, Qt::Orientation orientation, int role
   if(section<mDataColumns)  return QVariant();
   int flagno=section-mDataColumns;
   // display role
+  if(role==Qt::DisplayRole && mFlagCompact) 
+    return QString("Flags");
   if(role==Qt::DisplayRole) 
     return mFlagNames.at(flagno);
   // invalid
@@ -152,6 +208,7 @@ void LioVList::UpdateResize(void) {
   // bail out on no pending
   if(rowCount()!=0 && rowCount()==mUpdateOldRows && !mUpdateChanged)
     return;
+  mFlagGeneration++;
   // empty or content changed: force reset
   if(rowCount()<=0) {
     reset();
@@ -179,6 +236,7 @@ void LioVList::UpdateResize(void) {
 // resize hook: update all
 void LioVList::UpdateAll(void) { 
   FD_DQG("LioVList::UpdateAll(): rows " << rowCount());
+  mFlagGeneration++;
   QModelIndex index1, index2;
   index1=createIndex(0,0);
   index2=createIndex(rowCount()-1,columnCount()-1);
@@ -197,6 +255,7 @@ void LioVList::UpdateReset(void) {
 
 // resize hook: update row
 void LioVList::UpdateRow(int row) { 
+  if(row>=0 && row<mFlagCacheGen.size()) mFlagCacheGen[row]=-1;
   QModelIndex index1, index2;
   index1=createIndex(row,0);
   index2=createIndex(row,columnCount()-1);
@@ -208,6 +267,7 @@ void LioVList::UpdateRow(int row) {
 // tablemodel: number of columns
 int LioVList::columnCount(const QModelIndex &parent) const {
   (void) parent;
+  if(mFlagCompact) return mDataColumns+(mFlagColumns>0 ? 1 : 0);
   return mDataColumns+mFlagColumns;
 }
 
@@ -229,7 +289,7 @@ Qt::ItemFlags LioVList::flags(const QModelIndex &index) const {
     if(col<mDataColumns) 
       defaultFlags |= Qt::ItemIsEditable | Qt::ItemIsSelectable; 
     // faudes flag data ?
-    if(col>=mDataColumns) 
+    if(col>=mDataColumns && !mFlagCompact) 
       defaultFlags |= Qt::ItemIsUserCheckable;
   }
   //FD_DQG("LioVList::flags(" << this << "): done");
@@ -301,21 +361,22 @@ bool LioVList::setData(const QModelIndex &index, const QVariant& value, int role
   if(col >= columnCount()) return false;
   VioElement oelem=pVioGeneratorListModel->At(row);
   //** edit data: faudes flags 
-  if(col >= mDataColumns && role == Qt::CheckStateRole) {
+  if(col >= mDataColumns && role == Qt::CheckStateRole && !mFlagCompact) {
+    int prop=mFlagAddresses.at(col-mDataColumns);
     FD_DQG("LioVList::setData(...): editing flag at " << row << " " << col);
     if(!pVioGeneratorModel->ElementExists(oelem)) return false;
     if(value==Qt::Checked) 
-    if(!pVioGeneratorModel->ElementBooleanProperty(oelem,col-mDataColumns)) {
-      FD_DQG("LioVList::setData(...): set flag " << col-mDataColumns);
+    if(!pVioGeneratorModel->ElementBooleanProperty(oelem,prop)) {
+      FD_DQG("LioVList::setData(...): set flag " << prop);
       pVioGeneratorModel->UndoEditStart();
-      pVioGeneratorModel->ElementBooleanProperty(oelem,col-mDataColumns,true); 
+      pVioGeneratorModel->ElementBooleanProperty(oelem,prop,true); 
       pVioGeneratorModel->UndoEditStop();
     }
     if(value==Qt::Unchecked) 
-    if(pVioGeneratorModel->ElementBooleanProperty(oelem,col-mDataColumns)) {
-      FD_DQG("LioVList::setData(...): clr sflag " << col-mDataColumns);
+    if(pVioGeneratorModel->ElementBooleanProperty(oelem,prop)) {
+      FD_DQG("LioVList::setData(...): clr sflag " << prop);
       pVioGeneratorModel->UndoEditStart();
-      pVioGeneratorModel->ElementBooleanProperty(oelem,col-mDataColumns,false); 
+      pVioGeneratorModel->ElementBooleanProperty(oelem,prop,false); 
       pVioGeneratorModel->UndoEditStop();
     }    
     return true;
@@ -332,13 +393,12 @@ QVariant LioVList::data(const QModelIndex &index, int role) const {
   if(!index.isValid()) return QVariant();
   if(row >= rowCount()) return QVariant();
   if(col >= columnCount()) return QVariant();
-  // get element
-  const VioElement& elem=pVioGeneratorListModel->At(row);
+  // retrieve data: faudes flags (compact)
+  if(col >= mDataColumns && role == Qt::DisplayRole && mFlagCompact) 
+    return FlagText(row);
   // retrieve data: faudes flags
-  if(col >= mDataColumns && role == Qt::CheckStateRole) {
-    int flagno = col-mDataColumns;
-    bool bp =  pVioGeneratorModel->ElementBooleanProperty(elem,flagno);
-    if(bp) return QVariant(Qt::Checked);
+  if(col >= mDataColumns && role == Qt::CheckStateRole && !mFlagCompact) {
+    if(FlagTest(row,col-mDataColumns)) return QVariant(Qt::Checked);
     return QVariant(Qt::Unchecked);
   }
   return QVariant();
@@ -520,6 +580,7 @@ void LioTList::sort(int column, Qt::SortOrder order) {
     if(order==Qt::AscendingOrder) pVioGeneratorListModel->SortAscendingX2();
     else pVioGeneratorListModel->SortDescendingX2();
   }
+  mFlagGeneration++;
   reset();
   // track user edit
   Modified(true);
@@ -551,7 +612,7 @@ QVariant LioTList::data(const QModelIndex &index, int role) const {
     return VioStyle::Color(VioRed);
   }
   // retrieve data: faudes flags
-  if(col >= mDataColumns && role == Qt::CheckStateRole) {
+  if(col >= mDataColumns) {
     return LioVList::data(index,role);
   }
   return QVariant();
@@ -673,15 +734,18 @@ LioSList::LioSList(VioGeneratorListModel* genlist) : LioVList(genlist) {
   FD_DQG("LioSList::LioSList(" << genlist << ")");
   mDataColumns=1;
   InsertFlags(pVioGeneratorConfig->mStateAttribute->AttributeConfiguration()->BooleanProperties());
-  //mCompleter = new VioSymbolCompleter(this);
-  //mCompleter->setSymbolWorld(this,0);
   UpdateReset();
+  // feed shared symbol world
+  mSymbolWorld=VioSymbolWorld::Acquire(pVioGeneratorModel->SymbolWorldKey(VioElement::EState));
+  mSymbolWorld->setSource(this,0);
 };
 
 
 // destructor
 LioSList::~LioSList(void) {
   FD_DQG("LioSList::~LioSList()");
+  mSymbolWorld->setSource(0);
+  VioSymbolWorld::Release(mSymbolWorld);
 }
 
 // tabelmodel: headers
@@ -706,6 +770,7 @@ void LioSList::sort(int column, Qt::SortOrder order) {
     if(order==Qt::AscendingOrder) pVioGeneratorListModel->SortAscendingX1();
     else pVioGeneratorListModel->SortDescendingX1();
   }
+  mFlagGeneration++;
   reset();
   // track user edit
   Modified(true);
@@ -735,7 +800,7 @@ QVariant LioSList::data(const QModelIndex &index, int role) const {
     return VioStyle::Color(VioRed);
   }
   // retrieve data: faudes flags
-  if(col >= mDataColumns && role == Qt::CheckStateRole) {
+  if(col >= mDataColumns) {
     return LioVList::data(index,role);
   }
   return QVariant();
@@ -822,15 +887,18 @@ LioEList::LioEList(VioGeneratorListModel* genlist) : LioVList(genlist) {
   FD_DQG("LioEList::LioEList(" << genlist << ")");
   mDataColumns=1;
   InsertFlags(pVioGeneratorConfig->mEventAttribute->AttributeConfiguration()->BooleanProperties());
-  //mCompleter = new VioSymbolCompleter(this);
-  //mCompleter->setSymbolWorld(this,0);
   UpdateReset();
+  // feed shared symbol world
+  mSymbolWorld=VioSymbolWorld::Acquire(pVioGeneratorModel->SymbolWorldKey(VioElement::EEvent));
+  mSymbolWorld->setSource(this,0);
 };
 
 
 // destructor
 LioEList::~LioEList(void) {
   FD_DQG("LioEList::~LioEList()");
+  mSymbolWorld->setSource(0);
+  VioSymbolWorld::Release(mSymbolWorld);
 }
 
 // tabelmodel: headers
@@ -855,6 +923,7 @@ void LioEList::sort(int column, Qt::SortOrder order) {
     if(order==Qt::AscendingOrder) pVioGeneratorListModel->SortAscendingEv();
     else pVioGeneratorListModel->SortDescendingEv();
   }
+  mFlagGeneration++;
   reset();
   // track user edit
   Modified(true);
@@ -884,7 +953,7 @@ QVariant LioEList::data(const QModelIndex &index, int role) const {
     return VioStyle::Color(VioRed);
   }
   // retrieve data: faudes flags
-  if(col >= mDataColumns && role == Qt::CheckStateRole) {
+  if(col >= mDataColumns) {
     return LioVList::data(index,role);
   }
   return QVariant();
@@ -53,6 +53,10 @@ public:
   // configure faudes flag checkboxes
   void InsertFlags(const QList<VioBooleanProperty>& boolprops);
 
+  // flags as one compact read-only column (default off)
+  void CompactFlags(bool on);
+  bool CompactFlags(void) const { return mFlagCompact; };
+
   // convenience access to model hierarcy
   const faudes::vGenerator* Generator(void) const;
   VioGeneratorModel* GeneratorModel(void);
@@ -118,6 +122,16 @@ protected:
   QList<int> mFlagAddresses;
   int mDataColumns;
   int mFlagColumns;
+  bool mFlagCompact;
+
+  // flag cache: one bit per flag column, rows valid for the current generation
+  mutable QVector<quint64> mFlagCache;
+  mutable QVector<int> mFlagCacheGen;
+  mutable int mFlagGeneration;
+  mutable int mFlagRevision;
+  quint64 FlagWord(int row) const;
+  bool FlagTest(int row, int flagno) const;
+  QString FlagText(int row) const;
 
   // drag/drop hack
   QByteArray mDragData;
@@ -202,8 +216,8 @@ public:
 
 protected:
 
-  // completer with this model as source
-  VioSymbolCompleter* mCompleter;
+  // shared symbol world with this model as source
+  VioSymbolWorld* mSymbolWorld;
 
 };
 
@@ -240,8 +254,8 @@ public:
 
 protected:
 
-  // completer with this model as source
-  VioSymbolCompleter* mCompleter;
+  // shared symbol world with this model as source
+  VioSymbolWorld* mSymbolWorld;
 
 };
 
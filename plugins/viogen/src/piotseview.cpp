@@ -38,6 +38,10 @@ PioVProp::PioVProp(QWidget* parent, VioStyle* config) : QWidget(parent) {
   // symbolic name line edit
   mEditName=new VioSymbolEdit(this);  
 
+  // symbolic name completer (world is set with the generator)
+  mSymbolType=VioElement::EVoid;
+  mCompleter=new VioSymbolCompleter(this);
+
   // symbolic name label
   mLabelName = new QLabel(this);
   mLabelName->setText("Name");
@@ -95,8 +99,13 @@ void PioVProp::GeneratorModel(VioGeneratorModel* genmodel) {
   // record
   pVioGeneratorModel=genmodel;
   pGeneratorConfig = dynamic_cast<VioGeneratorStyle*>(genmodel->Configuration());
+  // detach from previous symbol world
+  mCompleter->clrSymbolWorld();
   // bail out on null
   if(!pVioGeneratorModel) return;
+  // attach to shared symbol world
+  if(mSymbolType!=VioElement::EVoid)
+    mCompleter->setSharedSymbolWorld(pVioGeneratorModel->SymbolWorldKey(mSymbolType));
   // connect model change
   connect(pVioGeneratorModel,SIGNAL(NotifyChange(void)),this,SLOT(UpdateView(void)));
   connect(pVioGeneratorModel,SIGNAL(NotifySelectionChange(void)),this,SLOT(ShowSelection(void)));
@@ -259,6 +268,9 @@ PioTProp::PioTProp(QWidget* parent, VioStyle* config) : PioVProp(parent, config)
 
   // adjust title
   mLabelName->setText("Label");
+  // complete events, search for large alphabets
+  mSymbolType=VioElement::EEvent;
+  mCompleter->setSearchMode(true);
  
   // clear view
   DoClear();
@@ -305,7 +317,7 @@ void PioTProp::DoVioUpdate(void) {
   // set my data: if its one transition
   if(mElement.Type()==VioElement::ETrans) 
   if(pVioGeneratorModel->ElementExists(mElement)) {
-    //mEditName->setCompleter(pVioGenerator->EventCompleter());
+    mEditName->setCompleter(mCompleter);
     Name(VioStyle::DispEventName(Generator(),mElement.Trans().Ev));
     faudes::AttributeFlags* attr=pVioGeneratorModel->ElementAttr(mElement);
     Attribute(attr);
@@ -413,6 +425,8 @@ PioSProp::PioSProp(QWidget* parent, VioStyle* config) : PioVProp(parent, config)
   FD_DQG("PioSProp(parent)");
   // adjust title
   mLabelName->setText("State"); 
+  // complete states
+  mSymbolType=VioElement::EState;
   // clear view
   DoClear();
 
@@ -458,7 +472,7 @@ void PioSProp::DoVioUpdate(void) {
   // set my data: if its one state 
   if(mElement.Type()==VioElement::EState) 
   if(pVioGeneratorModel->ElementExists(mElement)) {
-    //mEditName->setCompleter(pVioGenerator->StateCompleter());
+    mEditName->setCompleter(mCompleter);
     mEditName->setSymbolMode(VioSymbol::FakeSymbols);
     Name(VioStyle::DispStateName(Generator(),mElement.State()));
     //const faudes::AttributeVoid* attr=&Generator()->StateAttribute(mElement.State());
@@ -560,6 +574,9 @@ PioEProp::PioEProp(QWidget* parent, VioStyle* config) : PioVProp(parent, config)
   FD_DQG("PioEProp(parent)");
   // adjust title
   mLabelName->setText("Event");
+  // complete events, search for large alphabets
+  mSymbolType=VioElement::EEvent;
+  mCompleter->setSearchMode(true);
    // clear view
   DoClear();
 };
@@ -604,7 +621,7 @@ void PioEProp::DoVioUpdate(void) {
   // set my data: if its one state 
   if(mElement.Type()==VioElement::EEvent) 
   if(pVioGeneratorModel->ElementExists(mElement)) {
-    //mEditName->setCompleter(pVioGenerator->EventCompleter());
+    mEditName->setCompleter(mCompleter);
     Name(VioStyle::DispEventName(Generator(),mElement.Event()));
     faudes::AttributeFlags* attr=pVioGeneratorModel->ElementAttr(mElement);
     Attribute(attr);
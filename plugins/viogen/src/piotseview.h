@@ -139,6 +139,10 @@ protected:
   VioAttributeWidget* mAttribute;
   VioView* mConfigure;
 
+  // name completer, attached to the generators shared symbol world
+  VioElement::EType mSymbolType;
+  VioSymbolCompleter* mCompleter;
+
 };
 
 /*
@@ -156,6 +156,58 @@ void VioGeneratorLayout::Read(faudes::TokenReader& rTr) {
 }
 
 
+/*
+****************************************************************
+****************************************************************
+****************************************************************
+
+Implementation: VioStateIndexMap
+
+****************************************************************
+****************************************************************
+****************************************************************
+*/
+
+// construct
+VioStateIndexMap::VioStateIndexMap(void) : 
+  mOffset(0),
+  mIdentity(true)
+{}
+
+// clear to identity
+void VioStateIndexMap::Clear(void) {
+  mOffset=0;
+  mDense.clear();
+  mSparse.clear();
+  mIdentity=true;
+}
+
+// prepare
+void VioStateIndexMap::Reserve(faudes::Idx min, faudes::Idx max, int count) {
+  Clear();
+  if(max<min || count<=0) return;
+  // use flat table if the range is reasonably compact
+  faudes::Idx range=max-min+1;
+  if(range <= 4 * ((faudes::Idx) count) + 64) {
+    mOffset=min;
+    mDense.fill(0,range);
+    return;
+  }
+  // else prepare the hash
+  mSparse.reserve(count);
+}
+
+// record entry
+void VioStateIndexMap::Insert(faudes::Idx src, faudes::Idx dst) {
+  if(src==dst) return;
+  mIdentity=false;
+  if(src>=mOffset && src-mOffset < (faudes::Idx) mDense.size()) 
+    mDense[src-mOffset]=dst;
+  else 
+    mSparse.insert(src,dst);
+}
+
+
 /*
 ****************************************************************
 ****************************************************************
@@ -324,7 +376,8 @@ VioGeneratorModel::VioGeneratorModel(QObject* parent, VioStyle* config, bool all
   mStateList(0),
   mEventList(0),
   mGraph(0), 
-  mpUserLayout(0)
+  mpUserLayout(0),
+  mJournalLevel(0)
 {
   FD_DQG("VioGeneratorModel::VioGeneratorModel(): " << VioStyle::StrFromQStr(mFaudesType));
   // typed version of configuration
@@ -608,6 +661,7 @@ bool VioGeneratorModel::ElementExists(const VioElement& elem) const {
 // edit: ins element
 VioElement VioGeneratorModel::ElementIns(const VioElement& elem) {
   FD_DQG("VioGeneratorModel::ElementIns("<< elem.Str() << ")");
+  AboutToChange();
   // prepare res: invalid by default
   VioElement res;
   // switch types (proce for consise interface)
@@ -664,7 +718,7 @@ VioElement VioGeneratorModel::ElementIns(const VioElement& elem) {
     break;
   }
   // if we have a result, emit notification
-  if(!res.IsVoid()) { Modified(true); emit NotifyElementIns(res); }
+  if(!res.IsVoid()) { Modified(true); emit NotifyElementIns(res); JournalRecord(JIns,res); }
   FD_DQG("VioGeneratorModel::ElementIns("<< res.Str() << "): done");
   return res;
 }
@@ -672,6 +726,7 @@ VioElement VioGeneratorModel::ElementIns(const VioElement& elem) {
 // edit: del element
 VioElement VioGeneratorModel::ElementDel(const VioElement& elem) {
   FD_DQG("VioGeneratorModel::ElementDel("<< elem.Str() << ")");
+  AboutToChange();
   // todo: selection
   // prepare res: void
   VioElement res;
@@ -697,8 +752,10 @@ VioElement VioGeneratorModel::ElementDel(const VioElement& elem) {
     for(;tit!=mpFaudesGenerator->TransRelEnd();tit++) { 
       if(tit->X1==elem.State() || tit->X2==elem.State()) rmtrans.append(VioElement::FromTrans(*tit));
     }
+    mJournalLevel++;
     foreach(const VioElement& telem, rmtrans)
       ElementDel(telem);
+    mJournalLevel--;
     // delete state
     mpFaudesGenerator->DelState(elem.State()); 
     res=elem;
@@ -713,8 +770,10 @@ VioElement VioGeneratorModel::ElementDel(const VioElement& elem) {
     faudes::TransSet::Iterator tit=mpFaudesGenerator->TransRelBegin();
     for(;tit!=mpFaudesGenerator->TransRelEnd();tit++) 
       if(tit->Ev==elem.Event()) rmtrans.append(VioElement::FromTrans(*tit));
+    mJournalLevel++;
     foreach(const VioElement& telem, rmtrans)
       ElementDel(telem);
+    mJournalLevel--;
     // delete event
     mpFaudesGenerator->DelEvent(elem.Event()); 
     res=elem;
@@ -724,7 +783,7 @@ VioElement VioGeneratorModel::ElementDel(const VioElement& elem) {
     break;
   }
   // if we have a result, emit notification
-  if(!res.IsVoid()) { Modified(true); emit NotifyElementDel(res); }
+  if(!res.IsVoid()) { Modified(true); emit NotifyElementDel(res); JournalRecord(JDel,res); }
   FD_DQG("VioGeneratorModel::ElementDel("<< res.Str() << "): done");
   return res;
 }
@@ -742,6 +801,7 @@ VioElement VioGeneratorModel::ElementEdit(const VioElement& selem, const VioElem
     //emit NotifyElemetProp(selem); 
     return res;
   }
+  AboutToChange();
   // record selection
   bool sselected = IsSelected(selem); 
   if(sselected) Select(selem,false); 
@@ -786,7 +846,9 @@ VioElement VioGeneratorModel::ElementEdit(const VioElement& selem, const VioElem
       faudes::Transition dtrans=stelem.Trans();
       if(dtrans.X1==selem.State()) dtrans.X1=delem.State();
       if(dtrans.X2==selem.State()) dtrans.X2=delem.State();
+      mJournalLevel++;
       ElementEdit(stelem,VioElement::FromTrans(dtrans));
+      mJournalLevel--;
     }
     // delete old state
     mpFaudesGenerator->DelState(selem.State());
@@ -813,7 +875,9 @@ VioElement VioGeneratorModel::ElementEdit(const VioElement& selem, const VioElem
     foreach(const VioElement& stelem, mvtrans) {
       faudes::Transition dtrans=stelem.Trans();
       dtrans.Ev=delem.Event();
+      mJournalLevel++;
       ElementEdit(stelem,VioElement::FromTrans(dtrans));
+      mJournalLevel--;
     }
     // delete old event
     mpFaudesGenerator->DelEvent(selem.Event());
@@ -826,7 +890,7 @@ VioElement VioGeneratorModel::ElementEdit(const VioElement& selem, const VioElem
   // if we have a result, fix selection
   FD_DQG("VioGeneratorModel::ElementEdit("<< res.Str() << "): done");
   if(sselected) Select(res,true); 
-  if(!res.IsVoid()) Modified(true);
+  if(!res.IsVoid()) { Modified(true); JournalRecord(JEdit,selem,delem); }
   return res;
 }
 
@@ -839,6 +903,7 @@ VioElement VioGeneratorModel::ElementName(const VioElement& elem, const QString&
   // if elem non existent, do nothing
   if(!elem.IsVoid())
   if(!ElementExists(elem)) return res;
+  AboutToChange();
   // todo: selection 1. delete 2. move
   // rename in faudes generator ...
   switch(elem.Type()) {
@@ -865,7 +930,9 @@ VioElement VioGeneratorModel::ElementName(const VioElement& elem, const QString&
     // get new index/name global and use move
     faudes::Idx nidx = mpFaudesGenerator->InsEvent(newname);
     VioElement delem = VioElement::FromEvent(nidx);
+    mJournalLevel++;
     res=ElementEdit(elem,delem);
+    mJournalLevel--;
     break;
   }
   //** rename the generator
@@ -879,7 +946,7 @@ VioElement VioGeneratorModel::ElementName(const VioElement& elem, const QString&
   default: break;
   }
   FD_DQG("VioGeneratorModel::ElementName("<< elem.Str() << "): done");
-  if(!res.IsVoid()) { Modified(true);}
+  if(!res.IsVoid()) { Modified(true); JournalRecord(JName,elem,VioElement(),name); }
   return res;
 }
 
@@ -892,6 +959,7 @@ VioElement VioGeneratorModel::ElementAttr(const VioElement& elem, const faudes::
   if(!ElementExists(elem)) return res;
   // if the attribute is equal to the existing, do nothing
   if(ElementAttrTest(elem,attr)) return res;
+  AboutToChange();
   // a reference
   const faudes::AttributeVoid* pattr=&attr;
   // tweak state
@@ -931,6 +999,8 @@ VioElement VioGeneratorModel::ElementAttr(const VioElement& elem, const faudes::
   // done
   Modified(true); 
   emit NotifyElementProp(res); 
+  if(elem.IsVoid()) emit NotifyJournal(QByteArray());
+  else JournalRecord(JAttr,elem,VioElement(),VioStyle::QStrFromStr(attr.ToString()));
   FD_DQG("VioGeneratorModel::ElementAttr("<< res.Str() << "): done");
   return res;
 }
@@ -1068,6 +1138,7 @@ void VioGeneratorModel::Select(const VioElement& elem, bool on) {
 // seletion: all
 void VioGeneratorModel::SelectAllStates(void) {
   // reimplement to avoid per element signals
+  AboutToChange(true);
   mSelection.clear();
   faudes::StateSet::Iterator sit=mpFaudesGenerator->StatesBegin();
   for(;sit!=mpFaudesGenerator->StatesEnd();sit++)  
@@ -1079,6 +1150,7 @@ void VioGeneratorModel::SelectAllStates(void) {
 // seletion: all
 void VioGeneratorModel::SelectAllTransitions(void) {
   // reimplement to avoid per element signals
+  AboutToChange(true);
   mSelection.clear();
   faudes::TransSet::Iterator tit=mpFaudesGenerator->TransRelBegin();
   for(;tit!=mpFaudesGenerator->TransRelEnd();tit++)  
@@ -1188,61 +1260,88 @@ int VioGeneratorModel::TypeCheckData(const VioData* pData) {
 
 
 // merge data (return 1 on changes, assume type ok, select new items)
+// note: this is the bulk path for paste and undo/redo; we figure the state index map 
+// in one pass, insert elements set-wise and only copy names/attributes that are not default
 int VioGeneratorModel::DoMergeData(const VioData* pData) {
   FD_DQT("VioGeneratorModel::DoMergeData()");
   const VioGeneratorData* gdat= qobject_cast<const VioGeneratorData*>(pData);
   const faudes::vGenerator* gen = dynamic_cast<const faudes::vGenerator*>(pData->FaudesObject());
-  //gen->Write();
   // track changes
-  bool changed=false;
-  VioElement selelem;
-  // insert states: record map
-  QMap<faudes::Idx,faudes::Idx> dstidx;
+  bool changed= (gen->Size()>0) || (gen->AlphabetSize()>0);
+  // with an empty destination (e.g. undo/redo) there are no index or name conflicts
+  bool empty= (mpFaudesGenerator->Size()==0) && (mpFaudesGenerator->TransRelSize()==0);
+  // figure state index map in one pass: keep index if available, else use fresh index
+  VioStateIndexMap dstidx;
+  if(gen->Size()>0) 
+    dstidx.Reserve(*gen->StatesBegin(),gen->States().MaxIndex(),gen->Size());
+  faudes::StateSet dststates;
+  faudes::Idx fresh=qMax(mpFaudesGenerator->States().MaxIndex(),gen->States().MaxIndex())+1;
   faudes::StateSet::Iterator sit=gen->StatesBegin();
   for(;sit!=gen->StatesEnd(); sit++) {
     faudes::Idx x=*sit;
-    // inser the state as new index
-    if(mpFaudesGenerator->ExistsState(x)) 
-      x=mpFaudesGenerator->InsState();
-    else
-      mpFaudesGenerator->InsState(x);
-    // record new index
-    dstidx[*sit]=x;
-    // figure name
+    if(!empty) 
+    if(mpFaudesGenerator->ExistsState(x)) x=fresh++;
+    dstidx.Insert(*sit,x);
+    dststates.Insert(x);
+  }
+  // insert states and flags set-wise
+  mpFaudesGenerator->InsStates(dststates);
+  faudes::StateSet dstinit;
+  for(sit=gen->InitStatesBegin(); sit!=gen->InitStatesEnd(); sit++) 
+    dstinit.Insert(dstidx.Map(*sit));
+  mpFaudesGenerator->InsInitStates(dstinit);
+  faudes::StateSet dstmarked;
+  for(sit=gen->MarkedStatesBegin(); sit!=gen->MarkedStatesEnd(); sit++) 
+    dstmarked.Insert(dstidx.Map(*sit));
+  mpFaudesGenerator->InsMarkedStates(dstmarked);
+  // state names and non-default attributes
+  for(sit=gen->StatesBegin(); sit!=gen->StatesEnd(); sit++) {
     std::string xstr=gen->StateName(*sit); 
+    const faudes::AttributeVoid& xattr=gen->StateAttribute(*sit);
+    if(xstr=="" && xattr.IsDefault()) continue;
+    faudes::Idx x=dstidx.Map(*sit);
     if(xstr!="") {
-      xstr=mpFaudesGenerator->UniqueStateName(xstr); 
+      if(!empty) 
+      if(mpFaudesGenerator->ExistsState(xstr)) 
+        xstr=mpFaudesGenerator->UniqueStateName(xstr); 
       mpFaudesGenerator->StateName(x,xstr); 
     }
-    // figure attribute
-    if(gen->ExistsInitState(*sit)) mpFaudesGenerator->SetInitState(x);
-    if(gen->ExistsMarkedState(*sit)) mpFaudesGenerator->SetMarkedState(x);
-    mpFaudesGenerator->StateAttribute(x, gen->StateAttribute(*sit));
-    // track selection
-    if(selelem.Type()==VioElement::EState || selelem.Type()==VioElement::EVoid) { 
-      selelem=VioElement::FromState(x);
-      mSelection.append(selelem);
-    }
-    changed=true;
+    if(!xattr.IsDefault()) mpFaudesGenerator->StateAttribute(x,xattr);
   }
-  // insert events
+  // insert events set-wise, set attributes (existing events may carry other attributes)
+  bool noevents= (mpFaudesGenerator->AlphabetSize()==0);
+  mpFaudesGenerator->InsEvents(gen->Alphabet());
   faudes::EventSet::Iterator eit=gen->AlphabetBegin();
   for(;eit!=gen->AlphabetEnd(); eit++) {
-    mpFaudesGenerator->InsEvent(*eit);
-    mpFaudesGenerator->EventAttribute(*eit, gen->EventAttribute(*eit));
-    if(selelem.Type()==VioElement::EEvent || selelem.Type()==VioElement::EVoid) {
-      selelem=VioElement::FromEvent(*eit);
-      mSelection.append(selelem);
-    }
-    changed=true;
-  }
-  // insert transitions
-  faudes::TransSet::Iterator tit=gen->TransRelBegin();
-  for(;tit!=gen->TransRelEnd(); tit++) {
-    faudes::Transition ftrans(dstidx[tit->X1],tit->Ev,dstidx[tit->X2]);
-    mpFaudesGenerator->SetTransition(ftrans);
-    mpFaudesGenerator->TransAttribute(ftrans, gen->TransAttribute(*tit));
-  }
+    const faudes::AttributeVoid& eattr=gen->EventAttribute(*eit);
+    if(noevents && eattr.IsDefault()) continue;
+    mpFaudesGenerator->EventAttribute(*eit,eattr);
+  }
+  // insert transitions: set-wise if we can, else in sorted order
+  faudes::TransSet::Iterator tit;
+  if(empty) {
+    mpFaudesGenerator->InjectTransRel(gen->TransRel());
+  } else {
+    for(tit=gen->TransRelBegin(); tit!=gen->TransRelEnd(); tit++) 
+      mpFaudesGenerator->SetTransition(dstidx.Map(tit->X1),tit->Ev,dstidx.Map(tit->X2));
+  }
+  // set non-default transition attributes
+  for(tit=gen->TransRelBegin(); tit!=gen->TransRelEnd(); tit++) {
+    const faudes::AttributeVoid& tattr=gen->TransAttribute(*tit);
+    if(tattr.IsDefault()) continue;
+    faudes::Transition ftrans(dstidx.Map(tit->X1),tit->Ev,dstidx.Map(tit->X2));
+    mpFaudesGenerator->TransAttribute(ftrans,tattr);
+  }
+  // new selection in one go: states, or events if there are no states
+  QList<VioElement> newsel;
+  if(gen->Size()>0) {
+    for(sit=gen->StatesBegin(); sit!=gen->StatesEnd(); sit++) 
+      newsel.append(VioElement::FromState(dstidx.Map(*sit)));
+  } else {
+    for(eit=gen->AlphabetBegin(); eit!=gen->AlphabetEnd(); eit++) 
+      newsel.append(VioElement::FromEvent(*eit));
+  }
+  mSelection.append(newsel);
   // pass on abstract model data
   FD_DQT("VioGeneratorModel::DoMargeData(): insert abstract model data #"  << gdat->mDataList.size());
   for(int i=0; i<gdat->mDataList.size(); i++) {
@@ -1282,6 +1381,7 @@ int VioGeneratorModel::InsertData(const VioData* pData) {
   if(TypeCheckData(pData)!=0) return 1;
   const VioGeneratorData* gdat= qobject_cast<const VioGeneratorData*>(pData);
   const faudes::vGenerator* gen = dynamic_cast<const faudes::vGenerator*>(pData->FaudesObject());
+  AboutToChange();
   // do the insert (incl selection)
   bool changed=DoMergeData(pData);
   FD_DQG("VioGeneratorModel::InsertData(): changed " << changed);
@@ -1289,6 +1389,7 @@ int VioGeneratorModel::InsertData(const VioData* pData) {
   if(changed) {
     Modified(true);
     emit NotifyAnyChange();       // universal update
+    emit NotifyJournal(QByteArray());
   }
   // selction changed... perhaps
   emit NotifySelectionAny();    // universal selection change
@@ -1305,6 +1406,114 @@ void VioGeneratorModel::DeleteSelection(void) {
 }
 
 
+// graphics export by suffix (ret 0 on success)
+int VioGeneratorModel::ExportGraphics(const QString& rFilename) const {
+  FD_DQG("VioGeneratorModel::ExportGraphics(" << VioStyle::StrFromQStr(rFilename) << ")");
+  if(!mGraph) return 1;
+  QString suffix=QFileInfo(rFilename).suffix().toLower();
+  if(suffix=="svg") return mGraph->WriteSvg(rFilename);
+  if(suffix=="pdf") return mGraph->WritePdf(rFilename);
+  if(suffix=="eps") return mGraph->WriteEps(rFilename);
+  if(suffix=="png") return mGraph->WritePng(rFilename);
+  if(suffix=="jpg") return mGraph->WriteJpg(rFilename);
+  return 1;
+}
+
+// automatic layout (ret 0 on success)
+int VioGeneratorModel::AutoLayout(void) {
+  FD_DQG("VioGeneratorModel::AutoLayout()");
+  if(!mGraph) return 1;
+  AboutToChange();
+  if(mGraph->GraphScene()->DotConstruct()!=0) return 1;
+  mGraph->Modified(true);
+  return 0;
+}
+
+
+// change journal: record an edit operation
+void VioGeneratorModel::JournalRecord(JournalOp op, const VioElement& elem, const VioElement& delem, const QString& str) {
+  // nested edits are covered by the outer operation
+  if(mJournalLevel>0) return;
+  // encode
+  QByteArray record;
+  QDataStream out(&record,QIODevice::WriteOnly);
+  out << (qint8) op;
+  JournalWrite(out,elem);
+  JournalWrite(out,delem);
+  out << str;
+  emit NotifyJournal(record);
+}
+
+// change journal: encode element (events by name, states by index)
+void VioGeneratorModel::JournalWrite(QDataStream& out, const VioElement& elem) const {
+  QString evname;
+  if(elem.IsTrans() || elem.IsEvent()) 
+    evname=VioStyle::QStrFromStr(mpFaudesGenerator->EventName(elem.Ev()));
+  out << (qint8) elem.Type() << (quint32) elem.X1() << evname << (quint32) elem.X2();
+}
+
+// change journal: decode element (events get inserted to the symbol table)
+VioElement VioGeneratorModel::JournalRead(QDataStream& in) {
+  qint8 etype=VioElement::EVoid;
+  quint32 x1=0, x2=0;
+  QString evname;
+  in >> etype >> x1 >> evname >> x2;
+  faudes::Idx ev=0;
+  if(evname!="") 
+    ev=mpFaudesGenerator->EventSymbolTablep()->InsEntry(VioStyle::StrFromQStr(evname));
+  switch(etype) {
+    case VioElement::ETrans: return VioElement::FromTrans(faudes::Transition(x1,ev,x2));
+    case VioElement::EState: return VioElement::FromState(x1);
+    case VioElement::EEvent: return VioElement::FromEvent(ev);
+    default: break;
+  }
+  return VioElement();
+}
+
+// change journal: replay record (0 on success)
+int VioGeneratorModel::JournalReplay(const QByteArray& rRecord) {
+  FD_DQG("VioGeneratorModel::JournalReplay(): #" << rRecord.size());
+  if(rRecord.isEmpty()) return 1;
+  QDataStream in(rRecord);
+  qint8 op=0;
+  QString str;
+  in >> op;
+  int res=0;
+  try {
+    VioElement elem=JournalRead(in);
+    VioElement delem=JournalRead(in);
+    in >> str;
+    if(in.status()!=QDataStream::Ok) return 1;
+    switch(op) {
+    case JIns: 
+      ElementIns(elem); 
+      break;
+    case JDel: 
+      ElementDel(elem); 
+      break;
+    case JEdit: 
+      ElementEdit(elem,delem); 
+      break;
+    case JName: 
+      ElementName(elem,str); 
+      break;
+    case JAttr: {
+      faudes::AttributeFlags* attr=ElementAttr(elem);
+      attr->FromString(VioStyle::StrFromQStr(str));
+      ElementAttr(elem,*attr);
+      delete attr;
+      break;
+    }
+    default: 
+      res=1;
+    }
+  } catch(faudes::Exception& exception) {
+    res=1;
+  }
+  return res;
+}
+
+
 
 /*
 ****************************************************************
@@ -1493,6 +1702,8 @@ VioGeneratorView::VioGeneratorView(QWidget* parent, VioStyle* config, bool alloc
     pGeneratorConfig= new VioGeneratorStyle(mFaudesType);
   }
   mLayoutFlags=pGeneratorConfig->mLayoutFlags;
+  // selection is model based: can defer clipboard copy
+  mLazyCopy=true;
   // my alloc
   if(alloc) DoVioAllocate();
   FD_DQG("VioGeneratorView::VioGeneratorView(): done");
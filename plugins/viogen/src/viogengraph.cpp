@@ -109,16 +109,16 @@ int  VioGeneratorGraphData::FromTokenReader(faudes::TokenReader& rTr) {
 }
 
 
-// state reindeing
-void VioGeneratorGraphData::ApplyStateIndicees(const QMap<faudes::Idx,faudes::Idx> & rNewIdx) {
- for(int i=0; i<mStateItemsData.size(); i++) 
-   if(rNewIdx.contains(mStateItemsData[i].mIdx))
-     mStateItemsData[i].mIdx= rNewIdx.value(mStateItemsData[i].mIdx);
- for(int i=0; i<mTransItemsData.size(); i++) {
-   if(rNewIdx.contains(mTransItemsData[i].mIdxA))
-     mTransItemsData[i].mIdxA= rNewIdx.value(mTransItemsData[i].mIdxA);
-   if(rNewIdx.contains(mTransItemsData[i].mIdxB))
-     mTransItemsData[i].mIdxB= rNewIdx.value(mTransItemsData[i].mIdxB);
+// state reindeing (one linear pass per list)
+void VioGeneratorGraphData::ApplyStateIndicees(const VioStateIndexMap& rNewIdx) {
+ if(rNewIdx.IsIdentity()) return;
+ QList<GioState::Data>::iterator sit=mStateItemsData.begin();
+ for(;sit!=mStateItemsData.end();++sit) 
+   rNewIdx.Apply(sit->mIdx);
+ QList<GioTrans::Data>::iterator tit=mTransItemsData.begin();
+ for(;tit!=mTransItemsData.end();++tit) {
+   rNewIdx.Apply(tit->mIdxA);
+   rNewIdx.Apply(tit->mIdxB);
  }
 }
 
@@ -143,6 +143,7 @@ VioGeneratorGraphModel::VioGeneratorGraphModel(VioGeneratorModel* parent) :
   pVioGeneratorModel=parent;
   mGraphScene= new GioScene(this);
   connect(mGraphScene,SIGNAL(NotifyModified(bool)),this,SLOT(ChildModified(bool)));
+  connect(mGraphScene,SIGNAL(NotifyChange()),this,SLOT(ChildChange()));
   connect(mGraphScene,SIGNAL(MouseClick(const VioElement&)),pVioGeneratorModel,SIGNAL(MouseClick(const VioElement&)));
   connect(mGraphScene,SIGNAL(MouseDoubleClick(const VioElement&)),pVioGeneratorModel,SIGNAL(MouseDoubleClick(const VioElement&)));
   FD_DQG("VioGeneratorGraphModel::VioGeneratorGraphModel(): done");
@@ -337,12 +338,19 @@ int  VioGeneratorGraphModel::Data(const VioGeneratorAbstractData* pData) {
 void VioGeneratorGraphModel::Modified(bool ch) { 
   // call base (incl signal)
   VioGeneratorAbstractModel::Modified(ch);
+  // layout is not covered by the journal
+  if(ch) pVioGeneratorModel->JournalAnyChange();
   // pass on clr to childs
   if(!ch) {
     if(mGraphScene) mGraphScene->Modified(false);
   }
 }
 
+// record each change of the graph scene
+void VioGeneratorGraphModel::ChildChange(void) { 
+  Modified(true);
+}
+
 
 /*
 ****************************************************************
@@ -0,0 +1,434 @@
+/* violuabatch.cpp  - batch evaluation of lua function definitions  */
+
+
+/*
+   Graphical IO for FAU Discrete Event Systems Library (libfaudes)
+
+   Copyright (C) 2010 Thomas Moor
+
+*/
+
+
+//#define FAUDES_DEBUG_VIO_LUA
+
+#include "violuabatch.h"
+#include "violuafunction.h"
+
+
+/*
+ ************************************************
+ ************************************************
+
+ implementation of VioLuaBatchJob
+
+ ************************************************
+ ************************************************
+ */
+
+// construct
+VioLuaBatchJob::VioLuaBatchJob(const QString& definition, int variant,
+  const QStringList& files, int index, QObject* parent) :
+  QObject(parent),
+  mDefinition(definition),
+  mVariant(variant),
+  mFiles(files),
+  mIndex(index),
+  mProcess(0),
+  mCanceled(false),
+  mTime(0)
+{
+}
+
+// destruct
+VioLuaBatchJob::~VioLuaBatchJob(void) {
+  if(!mProcess) return;
+  mProcess->disconnect(this);
+  mProcess->kill();
+  mProcess->waitForFinished(-1);
+  delete mProcess;
+}
+
+// start worker process
+void VioLuaBatchJob::Start(void) {
+  if(mProcess) return;
+  FD_DQL("VioLuaBatchJob::Start(): #" << mIndex);
+  mErrString="";
+  mTime=0;
+  mCanceled=false;
+  // invoke myself recursively
+  QStringList args;
+  args << "-b" << "-e" << mDefinition << "-v" << QString::number(mVariant);
+  args << mFiles;
+  mProcess = new QProcess();
+  mProcess->setProcessChannelMode(QProcess::MergedChannels);
+  connect(mProcess,SIGNAL(finished(int,QProcess::ExitStatus)),
+    this,SLOT(ProcessDone(int,QProcess::ExitStatus)));
+  connect(mProcess,SIGNAL(error(QProcess::ProcessError)),
+    this,SLOT(ProcessError(QProcess::ProcessError)));
+  mClock.start();
+  mProcess->start(QCoreApplication::applicationFilePath(),args);
+}
+
+// kill worker
+void VioLuaBatchJob::Cancel(void) {
+  if(!mProcess) return;
+  FD_DQL("VioLuaBatchJob::Cancel(): #" << mIndex);
+  mCanceled=true;
+  mProcess->kill();
+}
+
+// worker failed to start (other errors are followed by finished)
+void VioLuaBatchJob::ProcessError(QProcess::ProcessError error) {
+  if(error!=QProcess::FailedToStart) return;
+  Done("cannot start worker process",mClock.elapsed());
+}
+
+// worker done: figure result from last report line
+void VioLuaBatchJob::ProcessDone(int code, QProcess::ExitStatus status) {
+  QString err="";
+  int msecs=-1;
+  QStringList lines=QString::fromLocal8Bit(mProcess->readAll()).split("\n");
+  foreach(const QString& line, lines) {
+    if(line.startsWith("evaluate: error: ")) { err=line.mid(17).trimmed(); msecs=-1; }
+    if(line.startsWith("evaluate: ok: ")) { err=""; msecs=line.mid(14).section(' ',0,0).toInt(); }
+  }
+  if(mCanceled) err="canceled";
+  else if(status!=QProcess::NormalExit) err="worker process crashed";
+  else if(err=="" && (code!=0 || msecs<0)) err=QString("worker process failed (exit code %1)").arg(code);
+  // report time of evaluation, or wall time if not available
+  Done(err, msecs>=0 ? msecs : mClock.elapsed());
+}
+
+// done
+void VioLuaBatchJob::Done(const QString& err, int msecs) {
+  if(!mProcess) return;
+  FD_DQL("VioLuaBatchJob::Done(): #" << mIndex << " (" << mClock.elapsed() << " ms)");
+  mErrString=err;
+  mTime=msecs;
+  mProcess->deleteLater();
+  mProcess=0;
+  emit finished();
+}
+
+
+/*
+ ************************************************
+ ************************************************
+
+ implementation of VioLuaBatch
+
+ ************************************************
+ ************************************************
+ */
+
+// construct
+VioLuaBatch::VioLuaBatch(QObject* parent) :
+  QObject(parent),
+  mDefinition(0),
+  mNext(0),
+  mRunning(0),
+  mWorkers(qMax(1,QThread::idealThreadCount())),
+  mDone(0),
+  mFailed(0)
+{
+}
+
+// destruct
+VioLuaBatch::~VioLuaBatch(void) {
+  // dont start any further jobs
+  mNext=mJobs.size();
+  // jobs kill their workers
+  qDeleteAll(mJobs);
+  if(mDefinition) delete mDefinition;
+}
+
+// start evaluation
+int VioLuaBatch::Start(const faudes::LuaFunctionDefinition* lfnct, int variant,
+  const QList<QStringList>& bindings)
+{
+  if(Pending()) return 1;
+  if(!lfnct || bindings.isEmpty()) return 1;
+  FD_DQL("VioLuaBatch::Start(): jobs #" << bindings.size());
+  // forget previous results
+  qDeleteAll(mJobs);
+  mJobs.clear();
+  mNext=0;
+  mRunning=0;
+  mDone=0;
+  mFailed=0;
+  // pass on the definition by file
+  if(mDefinition) delete mDefinition;
+  mDefinition = new QTemporaryFile(QDir::tempPath() + QDir::separator() + "violuabatch_XXXXXX.rti");
+  if(!mDefinition->open()) return 1;
+  mDefinition->close();
+  try {
+    lfnct->Write(VioStyle::LfnFromQStr(mDefinition->fileName()));
+  } catch(faudes::Exception& fex) {
+    FD_DQL("VioLuaBatch::Start(): " << fex.What());
+    return 1;
+  }
+  // set up jobs
+  for(int i=0; i<bindings.size(); i++) {
+    VioLuaBatchJob* job = new VioLuaBatchJob(mDefinition->fileName(),variant,bindings.at(i),i,this);
+    connect(job,SIGNAL(finished()),this,SLOT(JobDone()));
+    mJobs.append(job);
+  }
+  // start first jobs
+  StartNext();
+  return 0;
+}
+
+// start jobs up to the number of workers
+void VioLuaBatch::StartNext(void) {
+  while(mRunning<mWorkers && mNext<mJobs.size()) {
+    mRunning++;
+    mJobs.at(mNext++)->Start();
+  }
+}
+
+// report jobs not yet started and kill running workers
+void VioLuaBatch::Cancel(void) {
+  FD_DQL("VioLuaBatch::Cancel()");
+  QList<VioLuaBatchJob*> running;
+  for(int i=0; i<mNext; i++)
+    if(mJobs.at(i)->Pending()) running.append(mJobs.at(i));
+  while(mNext<mJobs.size()) 
+    Report(mJobs.at(mNext++),"canceled",0);
+  foreach(VioLuaBatchJob* job, running)
+    job->Cancel();
+}
+
+// job finished (callers thread)
+void VioLuaBatch::JobDone(void) {
+  VioLuaBatchJob* job = qobject_cast<VioLuaBatchJob*>(sender());
+  if(!job) return;
+  mRunning--;
+  Report(job,job->ErrString(),job->Time());
+  StartNext();
+}
+
+// report one job
+void VioLuaBatch::Report(VioLuaBatchJob* job, const QString& err, int msecs) {
+  mDone++;
+  if(err!="") mFailed++;
+  emit NotifyResult(job->Index(),err,msecs);
+  if(mDone==mJobs.size()) emit NotifyDone();
+}
+
+
+/*
+ ************************************************
+ ************************************************
+
+ implementation of VioLuaBatchDialog
+
+ ************************************************
+ ************************************************
+ */
+
+// construct
+VioLuaBatchDialog::VioLuaBatchDialog(VioLuaFunctionModel* lfnct, QWidget* parent) :
+  QDialog(parent),
+  pLfnct(lfnct),
+  mTotal(0),
+  mParams(0)
+{
+  setWindowTitle("Batch Execute: " + pLfnct->FaudesName());
+  // variant
+  mVariantBox = new QComboBox();
+  foreach(const faudes::Signature& sig, pLfnct->VioVariants())
+    mVariantBox->addItem(VioStyle::QStrFromStr(sig.Name()));
+  QHBoxLayout* hbox1 = new QHBoxLayout();
+  hbox1->addWidget(new QLabel("Variant:"));
+  hbox1->addWidget(mVariantBox,1);
+  // bindings
+  mTable = new QTableWidget();
+  mTable->setSelectionBehavior(QAbstractItemView::SelectItems);
+  mTable->horizontalHeader()->setStretchLastSection(true);
+  // status
+  mStatus = new QLabel();
+  // buttons
+  mAddButton = new QPushButton("Add Files ...");
+  mLoadButton = new QPushButton("Load List ...");
+  mClearButton = new QPushButton("Clear");
+  mRunButton = new QPushButton("Run");
+  mRunButton->setDefault(true);
+  mCancelButton = new QPushButton("Cancel");
+  mCloseButton = new QPushButton("Close");
+  QHBoxLayout* hbox2 = new QHBoxLayout();
+  hbox2->addWidget(mAddButton);
+  hbox2->addWidget(mLoadButton);
+  hbox2->addWidget(mClearButton);
+  hbox2->addStretch(1);
+  hbox2->addWidget(mRunButton);
+  hbox2->addWidget(mCancelButton);
+  hbox2->addWidget(mCloseButton);
+  // my layout
+  QVBoxLayout* vbox = new QVBoxLayout(this);
+  vbox->addLayout(hbox1);
+  vbox->addWidget(mTable,1);
+  vbox->addWidget(mStatus);
+  vbox->addLayout(hbox2);
+  resize(700,400);
+  // batch
+  mBatch = new VioLuaBatch(this);
+  // connect
+  connect(mVariantBox,SIGNAL(currentIndexChanged(int)),this,SLOT(UpdateVariant()));
+  connect(mAddButton,SIGNAL(clicked()),this,SLOT(AddFiles()));
+  connect(mLoadButton,SIGNAL(clicked()),this,SLOT(LoadList()));
+  connect(mClearButton,SIGNAL(clicked()),this,SLOT(Clear()));
+  connect(mRunButton,SIGNAL(clicked()),this,SLOT(Run()));
+  connect(mCancelButton,SIGNAL(clicked()),mBatch,SLOT(Cancel()));
+  connect(mCloseButton,SIGNAL(clicked()),this,SLOT(reject()));
+  connect(mBatch,SIGNAL(NotifyResult(int,QString,int)),this,SLOT(Result(int,QString,int)));
+  connect(mBatch,SIGNAL(NotifyDone()),this,SLOT(Done()));
+  // initialise
+  UpdateVariant();
+}
+
+// track variant
+void VioLuaBatchDialog::UpdateVariant(void) {
+  mParams=0;
+  QStringList header;
+  int pos=mVariantBox->currentIndex();
+  if(pos>=0 && pos<pLfnct->VioVariants().size()) {
+    const faudes::Signature& sig = pLfnct->VioVariants().at(pos);
+    mParams=sig.Size();
+    for(int i=0; i<mParams; i++)
+      header.append(QString("%1 (%2, %3)")
+        .arg(VioStyle::QStrFromStr(sig.At(i).Name()))
+        .arg(VioStyle::QStrFromStr(sig.At(i).Type()))
+        .arg(VioStyle::QStrFromStr(faudes::Parameter::AStr(sig.At(i).Attribute()))));
+  }
+  header << "Time [ms]" << "Result";
+  mTable->setColumnCount(mParams+2);
+  mTable->setHorizontalHeaderLabels(header);
+  UpdateStatus();
+}
+
+// add files to current column
+void VioLuaBatchDialog::AddFiles(void) {
+  if(mParams==0) return;
+  int col=mTable->currentColumn();
+  if(col<0 || col>=mParams) col=0;
+  QStringList files=QFileDialog::getOpenFileNames(this,"Add Files");
+  if(files.isEmpty()) return;
+  // fill from first empty cell
+  int row=0;
+  for(; row<mTable->rowCount(); row++) {
+    QTableWidgetItem* item=mTable->item(row,col);
+    if(!item || item->text()=="") break;
+  }
+  foreach(const QString& file, files) {
+    if(row>=mTable->rowCount()) mTable->insertRow(row);
+    mTable->setItem(row++,col,new QTableWidgetItem(file));
+  }
+  UpdateStatus();
+}
+
+// load bindings from list, one line per row
+void VioLuaBatchDialog::LoadList(void) {
+  QString filename=QFileDialog::getOpenFileName(this,"Load Binding List","",
+    "Text Files (*.txt);;All Files (*)");
+  if(filename=="") return;
+  QFile file(filename);
+  if(!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    mStatus->setText("cannot read " + filename);
+    return;
+  }
+  // relative names refer to the location of the list
+  QDir dir=QFileInfo(filename).absoluteDir();
+  QTextStream ts(&file);
+  while(!ts.atEnd()) {
+    QString line=ts.readLine().trimmed();
+    if(line=="" || line.startsWith("#")) continue;
+    QStringList files=line.split(QRegExp("[\\s;,]+"),QString::SkipEmptyParts);
+    int row=mTable->rowCount();
+    mTable->insertRow(row);
+    for(int col=0; col<files.size() && col<mParams; col++)
+      mTable->setItem(row,col,new QTableWidgetItem(dir.absoluteFilePath(files.at(col))));
+  }
+  UpdateStatus();
+}
+
+// clear bindings
+void VioLuaBatchDialog::Clear(void) {
+  if(mBatch->Pending()) return;
+  mTable->setRowCount(0);
+  UpdateStatus();
+}
+
+// run batch
+void VioLuaBatchDialog::Run(void) {
+  if(mBatch->Pending()) return;
+  if(mTable->rowCount()==0) return;
+  // ask all views to commit pending changes
+  pLfnct->FlushViews();
+  // collect bindings, clear results
+  QList<QStringList> bindings;
+  for(int row=0; row<mTable->rowCount(); row++) {
+    QStringList files;
+    for(int col=0; col<mParams; col++) {
+      QTableWidgetItem* item=mTable->item(row,col);
+      files.append(item ? item->text() : QString());
+    }
+    bindings.append(files);
+    mTable->setItem(row,mParams,new QTableWidgetItem());
+    mTable->setItem(row,mParams+1,new QTableWidgetItem());
+  }
+  // go
+  mTime.start();
+  if(mBatch->Start(pLfnct->LuaFunctionDefinition(),mVariantBox->currentIndex(),bindings)!=0) {
+    mStatus->setText("could not start evaluation");
+    return;
+  }
+  UpdateStatus();
+}
+
+// track results
+void VioLuaBatchDialog::Result(int index, QString err, int msecs) {
+  if(index<0 || index>=mTable->rowCount()) return;
+  QTableWidgetItem* titem=new QTableWidgetItem(QString::number(msecs));
+  titem->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+  mTable->setItem(index,mParams,titem);
+  QTableWidgetItem* ritem=new QTableWidgetItem(err=="" ? QString("ok") : err);
+  ritem->setToolTip(err);
+  if(err!="") ritem->setForeground(Qt::red);
+  mTable->setItem(index,mParams+1,ritem);
+  UpdateStatus();
+}
+
+// batch done
+void VioLuaBatchDialog::Done(void) {
+  mTotal=mTime.elapsed();
+  UpdateStatus();
+}
+
+// track status
+void VioLuaBatchDialog::UpdateStatus(void) {
+  bool pending=mBatch->Pending();
+  mVariantBox->setEnabled(!pending);
+  mAddButton->setEnabled(!pending && mParams>0);
+  mLoadButton->setEnabled(!pending && mParams>0);
+  mClearButton->setEnabled(!pending);
+  mRunButton->setEnabled(!pending && mTable->rowCount()>0 && mVariantBox->count()>0);
+  mCancelButton->setEnabled(pending);
+  if(mBatch->Size()==0) {
+    mStatus->setText(QString("%1 argument bindings").arg(mTable->rowCount()));
+    return;
+  }
+  mStatus->setText(QString("%1 of %2 done, %3 failed, %4 ms on %5 workers%6")
+    .arg(mBatch->Done()).arg(mBatch->Size()).arg(mBatch->Failed())
+    .arg(pending ? mTime.elapsed() : mTotal)
+    .arg(mBatch->Workers())
+    .arg(pending ? " ..." : ""));
+}
+
+// no close while running
+void VioLuaBatchDialog::reject(void) {
+  if(mBatch->Pending()) {
+    mBatch->Cancel();
+    return;
+  }
+  QDialog::reject();
+}
@@ -0,0 +1,258 @@
+/* violuabatch.h  - batch evaluation of lua function definitions */
+
+
+/*
+   Graphical IO for FAU Discrete Event Systems Library (libfaudes)
+
+   Copyright (C) 2010 Thomas Moor
+
+*/
+
+
+
+#ifndef FAUDES_VIOLUABATCH_H
+#define FAUDES_VIOLUABATCH_H
+
+// std includes
+#include "libviodes.h"
+
+// forward
+class VioLuaFunctionModel;
+
+
+/*
+ ************************************************
+ ************************************************
+
+ A VioLuaBatchJob evaluates one variant of a lua
+ function definition for one argument binding. The
+ binding is a list of file names, one per parameter:
+ In and InOut parameters are read from the respective
+ file, Out and InOut parameters are written back after
+ execution. Since the symbol table, the registries and
+ the console of libfaudes are not thread safe, the job
+ is run by a worker process, i.e., the application is
+ invoked recursively as in "vioedit -b -e definition 
+ -v variant files". Cancel() kills the worker.
+
+ ************************************************
+ ************************************************
+ */
+
+class VioLuaBatchJob : public QObject {
+
+  Q_OBJECT
+
+public:
+
+  // construct/destruct
+  VioLuaBatchJob(const QString& definition, int variant,
+    const QStringList& files, int index, QObject* parent=0);
+  ~VioLuaBatchJob(void);
+
+  // start worker process (callers thread)
+  void Start(void);
+
+  // worker running
+  bool Pending(void) const { return mProcess!=0; };
+
+  // access
+  int Index(void) const { return mIndex; };
+  const QStringList& Files(void) const { return mFiles; };
+
+  // result (valid after finished)
+  const QString& ErrString(void) const { return mErrString; };
+  int Time(void) const { return mTime; };
+
+public slots:
+
+  // kill worker
+  void Cancel(void);
+
+signals:
+
+  // job done
+  void finished(void);
+
+private slots:
+
+  // track worker
+  void ProcessDone(int code, QProcess::ExitStatus status);
+  void ProcessError(QProcess::ProcessError error);
+
+private:
+
+  // record result
+  void Done(const QString& err, int msecs);
+
+  // definition file and binding
+  QString mDefinition;
+  int mVariant;
+  QStringList mFiles;
+  int mIndex;
+
+  // worker
+  QProcess* mProcess;
+  QTime mClock;
+  bool mCanceled;
+
+  // result
+  QString mErrString;
+  int mTime;
+
+};
+
+
+/*
+ ************************************************
+ ************************************************
+
+ A VioLuaBatch sets up one VioLuaBatchJob per
+ argument binding and runs them in parallel, up to
+ one worker process per core. The function definition
+ is passed on to the workers by a temporary file. 
+ Results are streamed back as they come in. Cancel() 
+ reports jobs not yet started as canceled and kills
+ the running workers, so other evaluations are not
+ affected.
+
+ ************************************************
+ ************************************************
+ */
+
+class VioLuaBatch : public QObject {
+
+  Q_OBJECT
+
+public:
+
+  // construct/destruct
+  VioLuaBatch(QObject* parent=0);
+  ~VioLuaBatch(void);
+
+  // start evaluation (ret 0 on success)
+  int Start(const faudes::LuaFunctionDefinition* lfnct, int variant,
+    const QList<QStringList>& bindings);
+
+  // progress
+  bool Pending(void) const { return mDone < mJobs.size(); };
+  int Size(void) const { return mJobs.size(); };
+  int Done(void) const { return mDone; };
+  int Failed(void) const { return mFailed; };
+  int Workers(void) const { return mWorkers; };
+
+public slots:
+
+  // cancel all jobs of this batch
+  void Cancel(void);
+
+signals:
+
+  // one job done (empty string on success)
+  void NotifyResult(int index, QString err, int msecs);
+
+  // all jobs done
+  void NotifyDone(void);
+
+private slots:
+
+  // job finished
+  void JobDone(void);
+
+private:
+
+  // start jobs up to the number of workers
+  void StartNext(void);
+
+  // report one job
+  void Report(VioLuaBatchJob* job, const QString& err, int msecs);
+
+  // definition for workers
+  QTemporaryFile* mDefinition;
+
+  // jobs
+  QList<VioLuaBatchJob*> mJobs;
+  int mNext;
+  int mRunning;
+  int mWorkers;
+  int mDone;
+  int mFailed;
+
+};
+
+
+/*
+ ************************************************
+ ************************************************
+
+ The VioLuaBatchDialog lets the user choose a
+ variant and set up a table of argument bindings,
+ one row per evaluation and one column per parameter.
+ Files may be added per column, or loaded from a list
+ with one binding per line. Results are shown per
+ row as they come in.
+
+ ************************************************
+ ************************************************
+ */
+
+class VioLuaBatchDialog : public QDialog {
+
+  Q_OBJECT
+
+public:
+
+  // construct
+  VioLuaBatchDialog(VioLuaFunctionModel* lfnct, QWidget* parent=0);
+
+public slots:
+
+  // user actions
+  void AddFiles(void);
+  void LoadList(void);
+  void Clear(void);
+  void Run(void);
+
+protected slots:
+
+  // track variant
+  void UpdateVariant(void);
+
+  // track results
+  void Result(int index, QString err, int msecs);
+  void Done(void);
+
+protected:
+
+  // track status
+  void UpdateStatus(void);
+
+  // reimplement dialog: no close while running
+  virtual void reject(void);
+
+  // my model
+  VioLuaFunctionModel* pLfnct;
+
+  // batch
+  VioLuaBatch* mBatch;
+  QTime mTime;
+  int mTotal;
+
+  // layout items
+  QComboBox* mVariantBox;
+  QTableWidget* mTable;
+  QLabel* mStatus;
+  QPushButton* mAddButton;
+  QPushButton* mLoadButton;
+  QPushButton* mClearButton;
+  QPushButton* mRunButton;
+  QPushButton* mCancelButton;
+  QPushButton* mCloseButton;
+
+  // number of parameters
+  int mParams;
+
+};
+
+
+#endif
@@ -20,6 +20,14 @@
  ************************************************
  */
 
+// stop expressions, compiled once per pattern
+static const QRegExp* VioLuaStopExpression(const QString& pattern) {
+  static QHash<QString,QRegExp> cache;
+  QHash<QString,QRegExp>::iterator rit=cache.find(pattern);
+  if(rit==cache.end()) rit=cache.insert(pattern,QRegExp(pattern));
+  return &rit.value();
+}
+
 // parse block of LuaCodes
 void VioLuaCodeParser(const QTextBlock& block, VioLuaCodeHighlighter::BlockData* newstate, int position=-1) {
 
@@ -27,18 +35,16 @@ void VioLuaCodeParser(const QTextBlock& block, VioLuaCodeHighlighter::BlockData*
   static QRegExp mControlStartExpression("\\b(for|function|if|repeat|while)\\b");
   static QRegExp mMultilineStartExpression("(--\\[\\[)|(\\[=*\\[)");
   static QRegExp mFilterExpression("(--(?!\\[\\[)([^\\n]*))|(\"((\\\\.)|([^\\\\\"]))*\")|('((\\\\.)|([^\\\\']))*')"); // got it ;-)  comments,strings, sq strings
-  QRegExp mStopExpression;
-  // have an accumulator, initialise with previous state
+  // have an accumulator, initialise with previous state (shares the section stack)
   VioLuaCodeHighlighter::BlockData* state = 0;
   state = dynamic_cast< VioLuaCodeHighlighter::BlockData* >( block.previous().userData() );
   if(state) *newstate=*state;
   state = newstate;
-  FD_DQ("VioLuaCodeParser(): state #" << state->mSectionVector.size());
+  VioSectionStack<VioLuaCodeHighlighter::SectionInfo>& stack = state->mSectionStack;
+  FD_DQ("VioLuaCodeParser(): state #" << stack.Size());
   // clear position result
   state->mControlBegin.mName="";
   state->mControlEnd.mName="";
-  state->mComments.clear();
-  state->mStrings.clear();
   // parse this block for tags
   QString text= block.text();
   int offset=block.position();
@@ -46,11 +52,8 @@ void VioLuaCodeParser(const QTextBlock& block, VioLuaCodeHighlighter::BlockData*
   // remove single line comments and strings (if not in multiline mode ... this is not perfect:
   // technically, multilinemode can take place in a single line, at least for strings  ...)
   bool filter=true;
-  if(state->mSectionVector.size()>0) 
-  if(state->mSectionVector.back().mType==VioLuaCodeHighlighter::String) 
-    filter=false;
-  if(state->mSectionVector.size()>0) 
-  if(state->mSectionVector.back().mType==VioLuaCodeHighlighter::Comment) 
+  if(!stack.Empty()) 
+  if(stack.Top().mType==VioLuaCodeHighlighter::String || stack.Top().mType==VioLuaCodeHighlighter::Comment) 
     filter=false;
   int index=0;
   if(filter)
@@ -64,37 +67,44 @@ void VioLuaCodeParser(const QTextBlock& block, VioLuaCodeHighlighter::BlockData*
     index = index+length;
   }
   FD_DQ("VioLuaCodeParser(): filter " << block.blockNumber() << " text " << VioStyle::StrFromQStr(text));
-  // go for relevant keys
+  // go for relevant keys; matches are searched again only when passed (-2: search)
+  int index_ctrl=-2, length_ctrl=0;
+  int index_ml=-2, length_ml=0;
+  int index_stop=-2, length_stop=0;
   index = 0;
   while(index >= 0) {
     // seek for control/ml starts
-    int index_ctrl = mControlStartExpression.indexIn(text,index);
-    int index_ml   = mMultilineStartExpression.indexIn(text,index);
+    if(index_ctrl==-2 || (index_ctrl>=0 && index_ctrl<index)) {
+      index_ctrl = mControlStartExpression.indexIn(text,index);
+      length_ctrl = mControlStartExpression.matchedLength();
+    }
+    if(index_ml==-2 || (index_ml>=0 && index_ml<index)) {
+      index_ml = mMultilineStartExpression.indexIn(text,index);
+      length_ml = mMultilineStartExpression.matchedLength();
+    }
     // seek for relevant stop
-    int index_stop = -1;
-    if(state->mSectionVector.size()>0) {
-      mStopExpression.setPattern(state->mSectionVector.back().mStopExpression);
-      index_stop=mStopExpression.indexIn(text,index);
+    if(index_stop==-2 || (index_stop>=0 && index_stop<index)) {
+      index_stop=-1;
+      if(!stack.Empty()) {
+        const QRegExp* stopex=VioLuaStopExpression(stack.Top().mStopExpression);
+        index_stop=stopex->indexIn(text,index);
+        length_stop=stopex->matchedLength();
+      }
     }
-    // hack: ensure progress
-    index++; 
     // dont allow for starts in multiline
-    if(state->mSectionVector.size()>0) 
-      if(state->mSectionVector.back().mType==VioLuaCodeHighlighter::String) {
-        index_ctrl=-1;
-        index_ml=-1;
-      }
-    if(state->mSectionVector.size()>0) 
-      if(state->mSectionVector.back().mType==VioLuaCodeHighlighter::Comment) {
-        index_ctrl=-1;
-        index_ml=-1;
-      }
+    int ictrl=index_ctrl;
+    int iml=index_ml;
+    if(!stack.Empty()) 
+    if(stack.Top().mType==VioLuaCodeHighlighter::String || stack.Top().mType==VioLuaCodeHighlighter::Comment) {
+      ictrl=-1;
+      iml=-1;
+    }
     // case a) stop is first
     if(   index_stop>=0 && 
-	 (index_stop <= index_ctrl || index_ctrl <0) && 
-         (index_stop <= index_ml   || index_ml <0) ) 
+	 (index_stop <= ictrl || ictrl <0) && 
+         (index_stop <= iml   || iml <0) ) 
     {
-      int length = mStopExpression.matchedLength();
+      int length = length_stop;
       QString match = text.mid(index_stop,length);        
       FD_DQ("VioLuaCodeParser(): stop " << VioStyle::StrFromQStr(match) << " tag at " << 
         index_stop << " (#" << length <<")");
@@ -102,100 +112,69 @@ void VioLuaCodeParser(const QTextBlock& block, VioLuaCodeHighlighter::BlockData*
       if(position >= offset+index_stop)
       if(position <  offset+index_stop+length) {
         FD_DQ("VioLuaCodeParser(): end label at current position");
-     	state->mControlEnd.mPosition = offset+index_stop;
+     	state->mControlEnd.mBlock = block;
+     	state->mControlEnd.mOffset = index_stop;
 	state->mControlEnd.mLength = length;
         state->mControlEnd.mName = match;
-        if(state->mSectionVector.size()>0) 
-          state->mControlBegin=state->mSectionVector.back();
-      }
-      // if we have a string, record in strings
-      if(state->mSectionVector.size()>0) 
-      if(state->mSectionVector.back().mType==VioLuaCodeHighlighter::String) {
-        VioLuaCodeHighlighter::SectionInfo sinfo;
-        sinfo.mPosition=state->mSectionVector.back().mPosition;
-        sinfo.mLength=offset+index_stop+length - sinfo.mPosition;          
-        state->mStrings.append(sinfo);
-      }
-      // if we have a comment, record in comment
-      if(state->mSectionVector.size()>0) 
-      if(state->mSectionVector.back().mType==VioLuaCodeHighlighter::Comment) {
-        VioLuaCodeHighlighter::SectionInfo sinfo;
-        sinfo.mPosition=state->mSectionVector.back().mPosition;
-        sinfo.mLength=offset+index_stop+length - sinfo.mPosition;          
-        state->mComments.append(sinfo);
+        if(!stack.Empty()) 
+          state->mControlBegin=stack.Top();
       }
       // pop the state
-      if(state->mSectionVector.size()>0) {
-        state->mSectionVector.pop_back();       
-      } 
+      stack.Pop();       
       index=index_stop+length;
+      index_stop=-2;
       continue;
     } 
     // case b) start control is first
-    if(   index_ctrl>=0 && 
-	 (index_ctrl <= index_stop || index_stop <0) && 
-         (index_ctrl <= index_ml   || index_ml <0) ) 
+    if(   ictrl>=0 && 
+	 (ictrl <= index_stop || index_stop <0) && 
+         (ictrl <= iml   || iml <0) ) 
     {
-      int length = mControlStartExpression.matchedLength();
-      QString match = text.mid(index_ctrl,length);        
+      int length = length_ctrl;
+      QString match = text.mid(ictrl,length);        
       FD_DQ("VioLuaCodeParser(): start ctrl " << VioStyle::StrFromQStr(match) << 
-        " tag at " << index_ctrl << " (#" << length <<")");
+        " tag at " << ictrl << " (#" << length <<")");
       VioLuaCodeHighlighter::SectionInfo sinfo;
       sinfo.mName=match;
-      sinfo.mPosition=offset+index_ctrl;
+      sinfo.mBlock=block;
+      sinfo.mOffset=ictrl;
       sinfo.mLength=length;
       sinfo.mType=VioLuaCodeHighlighter::Control;
-      if(match=="for") sinfo.mStopExpression = "\\bend\\b"; 
-      else if(match=="function") sinfo.mStopExpression = "\\bend\\b"; 
-      else if(match=="if") sinfo.mStopExpression = "\\bend\\b"; 
-      else if(match=="repeat") sinfo.mStopExpression = "\\buntil\\b"; 
-      else if(match=="while") sinfo.mStopExpression = "\\bend\\b"; 
-      state->mSectionVector.push_back(sinfo);
-      index=index_ctrl+length;
+      if(match=="repeat") sinfo.mStopExpression = "\\buntil\\b"; 
+      else sinfo.mStopExpression = "\\bend\\b"; 
+      stack.Push(sinfo,qHash(sinfo.mName)*31 + sinfo.mOffset*7 + sinfo.mType);
+      index=ictrl+length;
+      index_stop=-2;
       continue;
     }
     // case c) start multiline is first
-    if(   index_ml>=0 && 
-	 (index_ml <= index_ctrl || index_ctrl <0) && 
-         (index_ml <= index_stop   || index_stop <0) ) {
-      int length = mMultilineStartExpression.matchedLength();
-      QString match = text.mid(index_ml,length);        
+    if(   iml>=0 && 
+	 (iml <= ictrl || ictrl <0) && 
+         (iml <= index_stop   || index_stop <0) ) {
+      int length = length_ml;
+      QString match = text.mid(iml,length);        
       FD_DQ("VioLuaCodeParser(): start ml " << VioStyle::StrFromQStr(match) << 
-        " tag at " << index_ml << " (#" << length <<")");
+        " tag at " << iml << " (#" << length <<")");
       VioLuaCodeHighlighter::SectionInfo sinfo;
       sinfo.mName=match;
-      sinfo.mPosition=offset+index_ml;
+      sinfo.mBlock=block;
+      sinfo.mOffset=iml;
       sinfo.mLength=length;
       sinfo.mType=VioLuaCodeHighlighter::String;
       if(match=="--[[") sinfo.mType=VioLuaCodeHighlighter::Comment;
       QString endex=match;
+      endex.remove(0,match.indexOf('['));
       endex.replace('[',"\\]");
       sinfo.mStopExpression = endex;
-      state->mSectionVector.push_back(sinfo);
-      index=index_ml+length;
+      stack.Push(sinfo,qHash(sinfo.mName)*31 + sinfo.mOffset*7 + sinfo.mType);
+      index=iml+length;
+      index_stop=-2;
+      continue;
     }
     // no matches at all: done
     break;
   } // parse loop
 
-  // record continuing strings
-  if(state->mSectionVector.size()>0) 
-  if(state->mSectionVector.back().mType==VioLuaCodeHighlighter::String) {
-     VioLuaCodeHighlighter::SectionInfo sinfo;
-     sinfo.mPosition=state->mSectionVector.back().mPosition;
-     sinfo.mLength=offset+block.length() - sinfo.mPosition;          
-     state->mStrings.append(sinfo);
-  }
-  // record continuing comments
-  if(state->mSectionVector.size()>0) 
-  if(state->mSectionVector.back().mType==VioLuaCodeHighlighter::Comment) {
-     VioLuaCodeHighlighter::SectionInfo sinfo;
-     sinfo.mPosition=state->mSectionVector.back().mPosition;
-     sinfo.mLength=offset+block.length() - sinfo.mPosition;          
-     state->mComments.append(sinfo);
-  }
-
-
 }
 
 
@@ -213,56 +192,160 @@ void VioLuaCodeParser(const QTextBlock& block, VioLuaCodeHighlighter::BlockData*
 VioLuaCodeHighlighter::VioLuaCodeHighlighter(QTextDocument *parent)
   : QSyntaxHighlighter(parent)
 {
-
-  HighlightingRule rule;
-
   mStringFormat.setFontItalic(true);
   mStringFormat.setForeground(VioStyle::Color(VioGreen));
-  rule.pattern = QRegExp("(\"((\\\\.)|([^\\\\\"]))*\")|('((\\\\.)|([^\\\\']))*')");
-  rule.format = mStringFormat;
-  mHighlightingRules.append(rule);
-
   mKeywordFormat.setForeground(VioStyle::Color(VioBlue));
-  rule.pattern = QRegExp("\\b(and|break|do|else|elseif|end|false|for|function|if|in|local|nil|not|or|repeat|return|then|true|until|while)\\b");
-  rule.format = mKeywordFormat;
-  mHighlightingRules.append(rule);
-
   mCommentFormat.setForeground(VioStyle::Color(VioRed));
-  rule.pattern = QRegExp("--[^\\n]*");
-  rule.format = mCommentFormat;
-  mHighlightingRules.append(rule);
+}
 
+// helper: test for long bracket at pos, return level or -1
+static int VioLuaLongBracket(const QChar* data, int len, int pos, QChar bracket) {
+  if(pos>=len || data[pos]!=bracket) return -1;
+  int level=0;
+  pos++;
+  while(pos<len && data[pos]=='=') { level++; pos++; }
+  if(pos>=len || data[pos]!=bracket) return -1;
+  return level;
+}
 
+// helper: find end of long bracket from pos, return position after closing or -1
+static int VioLuaLongBracketEnd(const QChar* data, int len, int pos, int level) {
+  for(; pos<len; pos++) {
+    if(data[pos]!=']') continue;
+    if(VioLuaLongBracket(data,len,pos,']')==level) return pos+level+2;
+  }
+  return -1;
+}
+
+// single-pass lexer
+// state: 0 for none, otherwise 1+(level<<1|comment) for open long bracket
+int VioLuaCodeHighlighter::Lexer(const QString& text, int state, QVector<Token>& rTokens) {
+  // keywords
+  static QSet<QString> keywords;
+  if(keywords.isEmpty()) 
+    keywords << "and" << "break" << "do" << "else" << "elseif" << "end" << "false" << "for" 
+      << "function" << "if" << "in" << "local" << "nil" << "not" << "or" << "repeat" 
+      << "return" << "then" << "true" << "until" << "while";
+  rTokens.clear();
+  const QChar* data=text.unicode();
+  int len=text.size();
+  int pos=0;
+  Token token;
+  // continue open long bracket
+  if(state>0) {
+    int level=(state-1)>>1;
+    token.mKind = ((state-1)&1) ? CommentToken : StringToken;
+    token.mPosition=0;
+    int end=VioLuaLongBracketEnd(data,len,0,level);
+    if(end<0) {
+      token.mLength=len;
+      rTokens.append(token);
+      return state;
+    }
+    token.mLength=end;
+    rTokens.append(token);
+    pos=end;
+  }
+  // scan
+  while(pos<len) {
+    QChar ch=data[pos];
+    // comments
+    if(ch=='-' && pos+1<len && data[pos+1]=='-') {
+      token.mKind=CommentToken;
+      token.mPosition=pos;
+      int level=VioLuaLongBracket(data,len,pos+2,'[');
+      if(level>=0) {
+        int end=VioLuaLongBracketEnd(data,len,pos+level+4,level);
+        if(end<0) {
+          token.mLength=len-pos;
+          rTokens.append(token);
+          return 1+((qMin(level,62)<<1)|1);
+        }
+        token.mLength=end-pos;
+        rTokens.append(token);
+        pos=end;
+        continue;
+      }
+      token.mLength=len-pos;
+      rTokens.append(token);
+      break;
+    }
+    // long strings
+    if(ch=='[') {
+      int level=VioLuaLongBracket(data,len,pos,'[');
+      if(level>=0) {
+        token.mKind=StringToken;
+        token.mPosition=pos;
+        int end=VioLuaLongBracketEnd(data,len,pos+level+2,level);
+        if(end<0) {
+          token.mLength=len-pos;
+          rTokens.append(token);
+          return 1+(qMin(level,62)<<1);
+        }
+        token.mLength=end-pos;
+        rTokens.append(token);
+        pos=end;
+        continue;
+      }
+      pos++;
+      continue;
+    }
+    // quoted strings
+    if(ch=='"' || ch=='\'') {
+      int end=pos+1;
+      while(end<len && data[end]!=ch) {
+        if(data[end]=='\\') end++;
+        end++;
+      }
+      if(end<len) end++;
+      token.mKind=StringToken;
+      token.mPosition=pos;
+      token.mLength=qMin(end,len)-pos;
+      rTokens.append(token);
+      pos=end;
+      continue;
+    }
+    // identifiers and keywords
+    if(ch.isLetter() || ch=='_') {
+      int end=pos+1;
+      while(end<len && (data[end].isLetterOrNumber() || data[end]=='_')) end++;
+      if(keywords.contains(QString::fromRawData(data+pos,end-pos))) {
+        token.mKind=Keyword;
+        token.mPosition=pos;
+        token.mLength=end-pos;
+        rTokens.append(token);
+      }
+      pos=end;
+      continue;
+    }
+    // numbers
+    if(ch.isDigit()) {
+      int end=pos+1;
+      while(end<len && (data[end].isLetterOrNumber() || data[end]=='.')) end++;
+      pos=end;
+      continue;
+    }
+    pos++;
+  }
+  return 0;
 }
 
 // re-implement highlighting
 void VioLuaCodeHighlighter::highlightBlock(const QString &text) {
 
-  // prepare my set of expressions
-  QMap<const HighlightingRule*, QRegExp> regex;
-  foreach(const HighlightingRule &rule, mHighlightingRules) 
-     regex[&rule]=QRegExp(rule.pattern);
-
-  // test rules for std highlighting
-  int index=0;
-  while(index >= 0) {
-    int mindex=-1;
-    int mlength=0;
-    const HighlightingRule* mrule=0;
-    foreach(const HighlightingRule &rule, mHighlightingRules) {
-      QRegExp& expression=regex[&rule];
-      int pindex = expression.indexIn(text,index);
-      int plength = expression.matchedLength();
-      if(pindex>=0 &&  (pindex < mindex || mindex<0)) {
-        mindex=pindex;
-        mlength=plength;
-        mrule=&rule;
-      }
+  // lexer state from previous block
+  int prevstate=previousBlockState();
+  int lexstate= prevstate<0 ? 0 : (prevstate & 0x7f);
+
+  // single pass for std highlighting
+  QVector<Token> tokens;
+  lexstate=Lexer(text,lexstate,tokens);
+  foreach(const Token& token, tokens) {
+    switch(token.mKind) {
+    case Keyword: setFormat(token.mPosition,token.mLength,mKeywordFormat); break;
+    case StringToken: setFormat(token.mPosition,token.mLength,mStringFormat); break;
+    case CommentToken: setFormat(token.mPosition,token.mLength,mCommentFormat); break;
     }
-    if(mindex>=0) {
-      setFormat(mindex, mlength, mrule->format);
-    }
-    index=mindex+mlength;
   }
 
   // parse for tags to propage state
@@ -270,26 +353,8 @@ void VioLuaCodeHighlighter::highlightBlock(const QString &text) {
   VioLuaCodeParser(currentBlock(),newstate);
   setCurrentBlockUserData(newstate);
   
-  // highligt multiline strings that occred during parse
-  for(int i=0; i<newstate->mStrings.size(); i++) {
-    int index = newstate->mStrings.at(i).mPosition - currentBlock().position();
-    int length = newstate->mStrings.at(i).mLength;
-    if(index<0) { length+=index; index=0;}
-    setFormat(index,length,mStringFormat);
-  }
-
-  // highligt multiline comments that occred during parse
-  for(int i=0; i<newstate->mComments.size(); i++) {
-    int index = newstate->mComments.at(i).mPosition - currentBlock().position();
-    int length = newstate->mComments.at(i).mLength;
-    if(index<0) { length+=index; index=0;}
-    setFormat(index,length,mCommentFormat);
-  }
-
-  // toggle qt state to trigger subsequent updates
-  // todo: only when state changed
-  setCurrentBlockState( currentBlockState()>0 ? 0 : 1);
-
+  // set qt state: subsequent blocks are updated only if this differs from before
+  setCurrentBlockState( (lexstate & 0x7f) | (newstate->Signature() << 7) );
 
 }
 
@@ -333,6 +398,7 @@ VioLuaCodeEditor::VioLuaCodeEditor(QWidget *parent) :
   lineNumberArea = new VioLCLineNumberArea(this);
   mHighLightLine=-1;
   connect(this, SIGNAL(textChanged()), this, SLOT(ShowLine()));
+  connect(this, SIGNAL(textChanged()), this, SLOT(ClearHeat()));
   connect(this, SIGNAL(blockCountChanged(int)), this, SLOT(updateLineNumberAreaWidth(int)));
   connect(this, SIGNAL(updateRequest(const QRect &, int)), this, SLOT(updateLineNumberArea(const QRect &, int)));
   //connect(this, SIGNAL(cursorPositionChanged()), this, SLOT(highlightCurrentLine()));
@@ -359,6 +425,19 @@ void VioLuaCodeEditor::ShowLine(int line) {
   lineNumberArea->update();
 }
 
+// set profile heat
+void VioLuaCodeEditor::Heat(const QMap<int,qreal>& heat) {
+  mHeat=heat;
+  lineNumberArea->update();
+}
+
+// clear profile heat (line numbers are invalid after edit)
+void VioLuaCodeEditor::ClearHeat(void) {
+  if(mHeat.isEmpty()) return;
+  mHeat.clear();
+  lineNumberArea->update();
+}
+
 
 // line numbers: width
 int VioLuaCodeEditor::lineNumberAreaWidth() {
@@ -404,6 +483,11 @@ void VioLuaCodeEditor::lineNumberAreaPaintEvent(QPaintEvent *event) {
 
   while(block.isValid() && top <= event->rect().bottom()) {
     if(block.isVisible() && bottom >= event->rect().top()) {
+      if(mHeat.contains(blockNumber+1)) {
+        qreal heat=mHeat.value(blockNumber+1);
+        QRect hirect=QRect(0,top,lineNumberArea->width(),fontMetrics().height());
+        painter.fillRect(hirect,QColor(192+(int)(63*heat),(int)(192*(1-heat)),(int)(192*(1-heat))));
+      }
       if(blockNumber +1 == mHighLightLine) {
         QRect hirect=QRect(0,top,lineNumberArea->width(),fontMetrics().height());
         painter.fillRect(hirect,Qt::red);
@@ -428,7 +512,7 @@ void VioLuaCodeEditor::TrackCursor(void) {
   const QTextBlock& block = cursor.block();
   VioLuaCodeHighlighter::BlockData posstate;
   VioLuaCodeParser(block,&posstate,cursor.position());  
-  FD_DQ("VioLuaCodeEditorTrackCursor(): posstate #" << posstate.mSectionVector.size());
+  FD_DQ("VioLuaCodeEditorTrackCursor(): posstate #" << posstate.mSectionStack.Size());
   // set visual feed back
   QList<QTextEdit::ExtraSelection> xsellist;
   QTextEdit::ExtraSelection xselect;
@@ -439,16 +523,16 @@ void VioLuaCodeEditor::TrackCursor(void) {
     xselect.format=mTagMissFormat;
   // visual end tag
   if(posstate.mControlEnd.mName!="") {
-    FD_DQ("VioLuaCodeHighlighter(): found cursor at end label pos " << posstate.mControlEnd.mPosition);
-    xselect.cursor.setPosition(posstate.mControlEnd.mPosition,QTextCursor::MoveAnchor);
-    xselect.cursor.setPosition(posstate.mControlEnd.mPosition+posstate.mControlEnd.mLength,QTextCursor::KeepAnchor);
+    FD_DQ("VioLuaCodeHighlighter(): found cursor at end label pos " << posstate.mControlEnd.Position());
+    xselect.cursor.setPosition(posstate.mControlEnd.Position(),QTextCursor::MoveAnchor);
+    xselect.cursor.setPosition(posstate.mControlEnd.Position()+posstate.mControlEnd.mLength,QTextCursor::KeepAnchor);
     xsellist.append(xselect);
   }
   // visual begin tag
-  if(posstate.mControlBegin.mName!="") {
-    FD_DQ("VioLuaCodeHighlighter(): found relevant begin label pos " << posstate.mControlBegin.mPosition);
-    xselect.cursor.setPosition(posstate.mControlBegin.mPosition,QTextCursor::MoveAnchor);
-    xselect.cursor.setPosition(posstate.mControlBegin.mPosition+posstate.mControlBegin.mLength,QTextCursor::KeepAnchor);
+  if(posstate.mControlBegin.mName!="" && posstate.mControlBegin.Position()>=0) {
+    FD_DQ("VioLuaCodeHighlighter(): found relevant begin label pos " << posstate.mControlBegin.Position());
+    xselect.cursor.setPosition(posstate.mControlBegin.Position(),QTextCursor::MoveAnchor);
+    xselect.cursor.setPosition(posstate.mControlBegin.Position()+posstate.mControlBegin.mLength,QTextCursor::KeepAnchor);
     xsellist.append(xselect);
   }
   // apply
@@ -24,7 +24,11 @@
  *****************************************************
 
  A VioLuaCodeHighlighter is a highlighter for faudes luacode
- formated text.
+ formated text. Formats are figured by a single-pass lexer.
+ The block state encodes the lexer state at the end of the
+ block plus a signature of the section nesting, so that
+ Qt re-highlights subsequent blocks only until the state 
+ resynchronises.
 
  *****************************************************
  *****************************************************
@@ -48,34 +52,25 @@ protected:
 
 private:
 
-  // my highlighting rules
-  struct HighlightingRule {
-    QRegExp pattern;
-    QTextCharFormat format;
-  };
-  QVector<HighlightingRule> mHighlightingRules;
-
-  
   // styles
   QTextCharFormat mCommentFormat;
   QTextCharFormat mSectionFormat;
   QTextCharFormat mStringFormat;
   QTextCharFormat mKeywordFormat;
 
-  // section nesting 
-  QRegExp mTagExpression;
-
 public:
 
   // section types
   typedef enum { None, Control, String, Comment } SectionType;
 
-  // section data 
+  // section data (position relative to block to survive edits elsewhere)
   class SectionInfo {
   public:
-    SectionInfo() { mType=None;};
+    SectionInfo() { mType=None; mOffset=0; mLength=0;};
+    int Position(void) const { return mBlock.isValid() ? mBlock.position()+mOffset : -1; };
     QString mName;
-    int     mPosition;
+    QTextBlock mBlock;
+    int     mOffset;
     int     mLength;
     QString mStopExpression;
     SectionType mType; 
@@ -85,13 +80,25 @@ public:
   class BlockData : public QTextBlockUserData {
   public:
     virtual ~BlockData(void) {};
-    QVector<SectionInfo> mSectionVector; // state = accumulated section starts
-    SectionInfo mControlBegin;           // highlight matching tags     
-    SectionInfo mControlEnd;             // highlight matching tags
-    QVector<SectionInfo> mStrings;       // highlight strings
-    QVector<SectionInfo> mComments;      // highlight comments
+    VioSectionStack<SectionInfo> mSectionStack; // state = accumulated section starts, shared
+    SectionInfo mControlBegin;                  // highlight matching tags     
+    SectionInfo mControlEnd;                    // highlight matching tags
+    int Signature(void) const { return mSectionStack.Hash() & 0xffffff; }; // compact state
   };
 
+  // lexer token kinds
+  typedef enum { Keyword, StringToken, CommentToken } TokenKind;
+
+  // lexer token
+  struct Token {
+    int mPosition;
+    int mLength;
+    TokenKind mKind;
+  };
+
+  // single-pass lexer (returns end state, 0 for none)
+  static int Lexer(const QString& text, int state, QVector<Token>& rTokens);
+
 };
 
 
@@ -133,11 +140,17 @@ public:
   int FontSize(void);
   void FontSize(int sz);
 
+  // profile heat per line (0..1, line numbers start at 1)
+  void Heat(const QMap<int,qreal>& heat);
+
 public slots:
 
   // show line (luacode error)
   void ShowLine(int line=-1);
 
+  // clear profile heat
+  void ClearHeat(void);
+
 protected:
 
   // reimplement
@@ -160,6 +173,9 @@ private:
   // line to highlight (luacode error)
   int mHighLightLine;
 
+  // profile heat per line
+  QMap<int,qreal> mHeat;
+
   // my font
   QFont mFont;
 
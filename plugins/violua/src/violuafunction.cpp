@@ -12,6 +12,7 @@
 //#define FAUDES_DEBUG_VIO_LUA
 
 #include "violuafunction.h"
+#include "violuabatch.h"
 
 /*
 ****************************************************************
@@ -30,7 +31,8 @@ VioLuaFunctionModel::VioLuaFunctionModel(QObject* parent, VioStyle* config, bool
   VioModel(parent, config, false),
   mpFaudesLuaFunctionDefinition(0), 
   pLuaStyle(0),
-  mUserLayout(0)
+  mUserLayout(0),
+  mpExecute(0)
 {
   FD_DQL("VioLuaFunctionModel::VioLuaFunctionModel(): " << VioStyle::StrFromQStr(mFaudesType));
   // have typed style
@@ -51,6 +53,11 @@ VioLuaFunctionModel::VioLuaFunctionModel(QObject* parent, VioStyle* config, bool
 
 // destruct
 VioLuaFunctionModel::~VioLuaFunctionModel(void) {
+  // wait for pending evaluation
+  if(mpExecute) {
+    mpExecute->Cancel();
+    delete mpExecute;
+  }
 }
 
 
@@ -173,6 +180,7 @@ void VioLuaFunctionModel::ExportFaudesFile(const QString& rFilename) const {
 
 // token io: faudes read from file
 void VioLuaFunctionModel::ImportFaudesFile(const QString& rFilename) {
+  AboutToChange();
   // read faudes rti format
   if(!PlainScript()) {
     mData->FaudesObject()->Read(VioStyle::LfnFromQStr(rFilename));
@@ -199,6 +207,7 @@ void VioLuaFunctionModel::ImportFaudesFile(const QString& rFilename) {
 void VioLuaFunctionModel::VioLuaCode(const QString& code) {
   // bail out on trivial
   if(mLuaCode==code) return;
+  AboutToChange();
   // doit
   FD_DQL("VioLuaFunctionModel::VioLuaCode(): set #" << code.size());
   mLuaCode=code;
@@ -219,6 +228,7 @@ void VioLuaFunctionModel::VioVariants(const QList<faudes::Signature>& variants)
   if(pLuaStyle->mPlainScript) return;
   // bail out on trivial
   if(mVariants==variants) return;
+  AboutToChange();
   // doit
   FD_DQL("VioLuaFunctionModel::VioVariants(): set #" << variants.size());
   mVariants.clear();
@@ -245,6 +255,7 @@ void VioLuaFunctionModel::VioVariant(int pos, const faudes::Signature& signature
   // bail out on doublets
   int opos=mpFaudesLuaFunctionDefinition->VariantIndex(signature.Name());
   if(opos!= pos && opos !=-1) return; 
+  AboutToChange();
   // doit vio
   FD_DQL("VioLuaFunctionModel::VioVariant(): set #" << pos);
   mVariants[pos]=signature;
@@ -261,32 +272,80 @@ void VioLuaFunctionModel::VioVariant(int pos, const faudes::Signature& signature
 // test/provoke errors (todo: fork/process etc)
 void VioLuaFunctionModel::TestScript(void) {
   FD_DQL("VioLuaFunctionView::TestScript()");
+  if(mpExecute) {
+    emit StatusMessage("evaluation in progress");
+    return;
+  }
   // ask al views to commit pending changes
   emit NotifyFlush();
   // syntax check
-  VioLuaExecute* exec = new VioLuaExecute(this,true);
-  QString err=exec->Execute();
-  delete exec;
-  // done
-  if(err=="") err="syntax check passed";
-  emit StatusMessage(err);
-  FD_DQL("VioLuaFunctionView::TestScript(): done");
+  mpExecute = new VioLuaExecute(this,true);
+  connect(mpExecute,SIGNAL(NotifyDone(QString)),this,SLOT(ScriptDone(QString)));
+  if(mpExecute->Start()!=0) return;
+  emit NotifyScriptPending(true);
+  FD_DQL("VioLuaFunctionView::TestScript(): started");
 }
 
 
 // run script (todo: fork/process etc)
 void VioLuaFunctionModel::RunScript(void) {
   FD_DQL("VioLuaFunctionView::RunScript()");
+  if(mpExecute) {
+    emit StatusMessage("evaluation in progress");
+    return;
+  }
   // ask al views to commit pending changes
   emit NotifyFlush();
   // do run
-  VioLuaExecute* exec = new VioLuaExecute(this);
-  QString err=exec->Execute();
-  delete exec;
-  // done
-  if(err=="") err="evaluation complete";
+  mpExecute = new VioLuaExecute(this);
+  connect(mpExecute,SIGNAL(NotifyDone(QString)),this,SLOT(ScriptDone(QString)));
+  if(mpExecute->Start()!=0) return;
+  emit StatusMessage("evaluating ...");
+  emit NotifyScriptPending(true);
+  FD_DQL("VioLuaFunctionView::RunScript(): started");
+}
+
+// run script with profiler
+void VioLuaFunctionModel::ProfileScript(void) {
+  FD_DQL("VioLuaFunctionView::ProfileScript()");
+  if(mpExecute) {
+    emit StatusMessage("evaluation in progress");
+    return;
+  }
+  // ask al views to commit pending changes
+  emit NotifyFlush();
+  // do run
+  mpExecute = new VioLuaExecute(this,false,true);
+  connect(mpExecute,SIGNAL(NotifyDone(QString)),this,SLOT(ScriptDone(QString)));
+  if(mpExecute->Start()!=0) return;
+  emit StatusMessage("profiling ...");
+  emit NotifyScriptPending(true);
+  FD_DQL("VioLuaFunctionView::ProfileScript(): started");
+}
+
+// cancel evaluation
+void VioLuaFunctionModel::CancelScript(void) {
+  if(mpExecute) mpExecute->Cancel();
+}
+
+// evaluation done
+void VioLuaFunctionModel::ScriptDone(QString err) {
+  if(!mpExecute) return;
+  FD_DQL("VioLuaFunctionView::ScriptDone()");
+  bool test=mpExecute->Test();
+  bool profile=mpExecute->Profiling();
+  if(profile) mProfile=mpExecute->Profile();
+  mpExecute->deleteLater();
+  mpExecute=0;
+  // report
+  emit NotifyScriptPending(false);
+  emit NotifyScriptDone(err);
+  if(profile) {
+    FAUDES_WRITE_CONSOLE(VioStyle::StrFromQStr(mProfile.Summary()));
+    emit NotifyProfile();
+  }
+  if(err=="") err= test ? "syntax check passed" : "evaluation complete";
   emit StatusMessage(err);
-  FD_DQL("VioLuaFunctionView::RunScript(): done");
 }
 
 
@@ -470,10 +529,22 @@ void VioLuaFunctionView::DoVioAllocate(void) {
   mRunAction->setEnabled(false);
   mRunAction->setShortcut(tr("Ctrl+Shift+E"));
   mEditActions.append(mRunAction);
-  if(pLuaStyle->mPlainScript) 
+  mBatchAction = new QAction("Batch Execute ...",this);
+  mBatchAction->setEnabled(false);
+  mEditActions.append(mBatchAction);
+  mProfileAction = new QAction("Profile Script",this);
+  mProfileAction->setEnabled(false);
+  mEditActions.append(mProfileAction);
+  mExportProfileAction = new QAction("Export Profile ...",this);
+  mExportProfileAction->setEnabled(false);
+  mEditActions.append(mExportProfileAction);
+  if(pLuaStyle->mPlainScript) {
     mRunAction->setEnabled(true);
-  else
+    mProfileAction->setEnabled(true);
+  } else {
     mTestAction->setEnabled(true);
+    mBatchAction->setEnabled(true);
+  }
   mZoomInAction = new QAction("Zoom In",this);
   mZoomInAction->setEnabled(true);
   mZoomInAction->setShortcut(tr("Ctrl++"));
@@ -507,6 +578,10 @@ void VioLuaFunctionView::DoVioAllocate(void) {
      this,SLOT(ZoomIn(void)));
   QObject::connect(mZoomOutAction,SIGNAL(triggered(bool)),
      this,SLOT(ZoomOut(void)));
+  QObject::connect(mBatchAction,SIGNAL(triggered(bool)),
+     this,SLOT(BatchDialog(void)));
+  QObject::connect(mExportProfileAction,SIGNAL(triggered(bool)),
+     this,SLOT(ExportProfile(void)));
   // done
   FD_DQL("VioLuaFunctionView::DoVioAllocate(): done");
 }
@@ -530,10 +605,22 @@ void VioLuaFunctionView::DoVioUpdate(void) {
   // fix my action
   QObject::disconnect(mTestAction,0,0,0);
   QObject::disconnect(mRunAction,0,0,0);
+  QObject::disconnect(mProfileAction,0,0,0);
   QObject::connect(mTestAction,SIGNAL(triggered(bool)),
      pLuaFunctionModel,SLOT(TestScript(void)));
   QObject::connect(mRunAction,SIGNAL(triggered(bool)),
      pLuaFunctionModel,SLOT(RunScript(void)));
+  QObject::connect(mProfileAction,SIGNAL(triggered(bool)),
+     pLuaFunctionModel,SLOT(ProfileScript(void)));
+  QObject::disconnect(pLuaFunctionModel,SIGNAL(NotifyProfile(void)),
+     this,SLOT(ProfileDone(void)));
+  QObject::connect(pLuaFunctionModel,SIGNAL(NotifyProfile(void)),
+     this,SLOT(ProfileDone(void)));
+  QObject::disconnect(pLuaFunctionModel,SIGNAL(NotifyScriptPending(bool)),
+     this,SLOT(ScriptPending(bool)));
+  QObject::connect(pLuaFunctionModel,SIGNAL(NotifyScriptPending(bool)),
+     this,SLOT(ScriptPending(bool)));
+  ScriptPending(pLuaFunctionModel->ScriptPending());
   // reconnect modification not
   QObject::disconnect(this,SIGNAL(NotifyModified(bool)),0,0);
   QObject::connect(this,SIGNAL(NotifyModified(bool)),pLuaFunctionModel,
@@ -683,6 +770,43 @@ void VioLuaFunctionView::ShowPropertyView(bool on) {
   SaveUserLayout();
 }
  
+// track evaluation
+void VioLuaFunctionView::ScriptPending(bool pending) {
+  mTestAction->setEnabled(!pending);
+  mRunAction->setEnabled(!pending);
+  mProfileAction->setEnabled(!pending);
+}
+
+// batch evaluation (non-modal, independent of pending script)
+void VioLuaFunctionView::BatchDialog(void) {
+  if(!pLuaFunctionModel) return;
+  VioLuaBatchDialog* dlg = new VioLuaBatchDialog(pLuaFunctionModel,this);
+  dlg->setAttribute(Qt::WA_DeleteOnClose);
+  dlg->show();
+}
+
+// profile available: show heat in gutter
+void VioLuaFunctionView::ProfileDone(void) {
+  if(!pLuaFunctionModel) return;
+  const VioLuaProfile& profile=pLuaFunctionModel->Profile();
+  mCodeEdit->Heat(profile.Heat());
+  mExportProfileAction->setEnabled(!profile.Empty());
+}
+
+// export folded stacks (for flamegraph.pl and the like)
+void VioLuaFunctionView::ExportProfile(void) {
+  if(!pLuaFunctionModel) return;
+  if(pLuaFunctionModel->Profile().Empty()) return;
+  QString filename=QFileDialog::getSaveFileName(this,"Export Profile","",
+    "Folded Stacks (*.folded);;All Files (*)");
+  if(filename=="") return;
+  if(pLuaFunctionModel->Profile().WriteFolded(filename)!=0) {
+    emit ErrorMessage("cannot write " + filename);
+    return;
+  }
+  emit StatusMessage("profile exported to " + filename);
+}
+
 // reimplemengt std edit from viotype
 void VioLuaFunctionView::Cut(void) {
   mCodeEdit->cut();
@@ -816,7 +940,7 @@ void VioLuaFunctionPropertyView::DoVioAllocate(void) {
   mParameterTable->setSymbolMode(0,VioSymbol::AnyString);
   mParameterTable->setSymbolMode(1,VioSymbol::KnownSymbolsOnly);
   mParameterTable->setSymbolMode(2,VioSymbol::KnownSymbolsOnly);
-  mParameterTable->setSymbolWorld(1,VioTypeRegistry::UserTypes());
+  mParameterTable->setSharedSymbolWorld(1,"VioTypeRegistry::UserTypes",VioTypeRegistry::UserTypes());
   mParameterTable->setSymbolWorld(2,QStringList() << "In" << "Out" << "InOut");
   mParameterTable->setEnabled(false);
   //mVbox->addWidget(mSignatureList);
@@ -1107,76 +1231,103 @@ int VioLuaFunctionWidget::Model(VioModel* model) {
 
 
 // construct/destruct
-VioLuaExecute::VioLuaExecute(VioLuaFunctionModel* lfnct, bool test) : 
-  QThread(lfnct) 
+VioLuaExecute::VioLuaExecute(VioLuaFunctionModel* lfnct, bool test, bool profile) : 
+  VioLuaJob(lfnct),
+  mLFfnct(0),
+  mProgress(0)
 {
   pLfnct=lfnct;
   mTest=test;
+  mProfiling=profile && !test;
+  connect(this,SIGNAL(finished()),this,SLOT(Done()));
 };
 
 // destruct  
 VioLuaExecute::~VioLuaExecute(void) {
+  Withdraw();
+  if(mLFfnct) delete mLFfnct;
+  if(mProgress) delete mProgress;
 };
 
 
-// run (this is the thread itself, called by start()
-void VioLuaExecute::run(void) {
-  FD_DQL("VioLuaExecute::run()");
-  if(mTest)
-    mErrString=VioStyle::QStrFromStr(pLFfnct->SyntaxCheck());
-  else
-    mErrString=VioStyle::QStrFromStr(pLFfnct->Evaluate());
+// run (this is the worker thread, operating on the global lua state or, for
+// a syntax check, on the workers state)
+void VioLuaExecute::Run(faudes::LuaState* pL) {
+  FD_DQL("VioLuaExecute::Run()");
+  if(mTest) {
+    mErrString=SyntaxCheck(pL);
+  } else if(mProfiling) {
+    VioLuaProfiler profiler;
+    profiler.Start(pL->LL());
+    mErrString=VioStyle::QStrFromStr(mLFfnct->Evaluate(pL));
+    profiler.Stop();
+    mProfile=profiler.Profile();
+  } else {
+    mErrString=VioStyle::QStrFromStr(mLFfnct->Evaluate(pL));
+  }
   // done
-  FD_DQL("VioLuaExecute::run(): done");
+  FD_DQL("VioLuaExecute::Run(): done");
 };
 
+// syntax check all variants on the specified state (the faudes version sets up a fresh one)
+QString VioLuaExecute::SyntaxCheck(faudes::LuaState* pL) {
+  QString err="";
+  faudes::Function* fnct=0;
+  try {
+    fnct = mLFfnct->NewFunction();
+    faudes::LuaFunction* lfnct = dynamic_cast<faudes::LuaFunction*>(fnct);
+    if(!lfnct)
+      throw faudes::Exception("VioLuaExecute::SyntaxCheck", "could not access lua code", 47);
+    lfnct->L(pL);
+    for(int i=0; i<lfnct->VariantsSize() && err==""; i++) {
+      lfnct->Variant(i);
+      try {
+        lfnct->AllocateValues();
+        lfnct->SyntaxCheck();
+      } catch(faudes::Exception& fex) {
+        err=VioStyle::QStrFromStr(fex.What());
+      }
+      lfnct->FreeValues();
+    }
+  } catch(faudes::Exception& fex) {
+    err=VioStyle::QStrFromStr(fex.What());
+  }
+  if(fnct) delete fnct;
+  return err;
+}
+
 
 // api: this is callers thread
-QString VioLuaExecute::Execute(void) {
+int VioLuaExecute::Start(void) {
   // prepare
   mErrString="";
   const faudes::LuaFunctionDefinition* lfnct = pLfnct->LuaFunctionDefinition();
-  if(!lfnct) { 
+  if(lfnct) mLFfnct = dynamic_cast<faudes::LuaFunctionDefinition*>(lfnct->Copy());
+  if(!mLFfnct) { 
     mErrString="could not access lua code";
-    return mErrString;
+    QMetaObject::invokeMethod(this,"NotifyDone",Qt::QueuedConnection,Q_ARG(QString,mErrString));
+    return 1;
   } 
-  pLFfnct = const_cast<faudes::LuaFunctionDefinition*>(lfnct);
-  // doit
-  QApplication::processEvents();
-  QApplication::flush();
-  // have a progress dialog
-  QProgressDialog progress("Evaluating: "+pLfnct->FaudesName(), "Cancel", 0, 0, 0); 
-  progress.setWindowModality(Qt::ApplicationModal);
-  progress.setValue(0);
-  QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
-  QApplication::flush();
-  // clear global break flag
-  VioStyle::FaudesBreakClr(); 
-  // run extra thread
-  start();
-  // process applicationevent loop while running
-  FD_DS("WspExecute():: thread started");
-  long int i=100; 
-  while(isRunning() && (--i)>0) {
-    QApplication::processEvents(QEventLoop::ExcludeUserInputEvents,10);
-    QApplication::flush();
-    wait(10);
-  }
-  FD_DS("WspExecute():: progress on");
-  bool canceled=false;
-  while(isRunning()) {
-    QApplication::processEvents(QEventLoop::AllEvents,10);
-    QApplication::flush();
-    if(progress.wasCanceled() && !canceled) {
-       VioStyle::FaudesBreakSet(); 
-       FD_DS("WspExecute():: canceled");
-       canceled=true;
-    }
-    progress.setValue(1); 
-    wait(10);
-  }
-  // clear global break flag
-  VioStyle::FaudesBreakClr(); 
+  // have a non-modal progress dialog
+  mProgress = new VioProgressDialog("Evaluating: "+pLfnct->FaudesName());
+  connect(mProgress,SIGNAL(canceled()),this,SLOT(Cancel()));
+  // pass on to worker pool (resets my cancellation context)
+  Submit();
+  FD_DS("WspExecute():: job submitted");
+  return 0;
+}
+
+// api: request break
+void VioLuaExecute::Cancel(void) {
+  if(!Pending()) return;
+  FD_DS("WspExecute():: canceled");
+  VioLuaJob::Cancel(); 
+}
+
+// job finished (callers thread)
+void VioLuaExecute::Done(void) {
+  if(mProgress) mProgress->deleteLater();
+  mProgress=0;
   // parse exception message for line number
   if(mErrString.startsWith("error in Lua script:")) {
     int c1 = mErrString.indexOf(": line ");
@@ -1191,7 +1342,6 @@ QString VioLuaExecute::Execute(void) {
     }
   }
   // done
-  return mErrString;
+  emit NotifyDone(mErrString);
 }
 
-
@@ -20,6 +20,9 @@
 #include "violuastyle.h"
 #include "violuacode.h"
 
+// need profiler
+#include "violuaprofile.h"
+
 
 /*
  ************************************************
@@ -38,6 +41,7 @@ class VioLuaFunctionLayout;
 class VioLuaFunctionView;
 class VioLuaFunctionPropertyView;
 class VioLuaFunctionWidget;
+class VioLuaExecute;
 
 
 class VioLuaFunctionModel : public VioModel {
@@ -86,12 +90,24 @@ public:
   bool Modified(void) const;
   virtual void Modified(bool ch);
 
+  // evaluation in progress
+  bool ScriptPending(void) const { return mpExecute!=0; };
+
+  // result of last profiling run
+  const VioLuaProfile& Profile(void) const { return mProfile; };
+
 public slots:
 
-  // test/provoke errors
+  // test/provoke errors (non-blocking, result via StatusMessage)
   void TestScript(void);
   void RunScript(void);
 
+  // run with profiler (non-blocking, result via NotifyProfile)
+  void ProfileScript(void);
+
+  // cancel pending evaluation
+  void CancelScript(void);
+
   // collect changes
   void ChildModified(bool changed);
 
@@ -101,6 +117,18 @@ signals:
   void NotifySignatureChange(void);  
   void NotifyCodeChange(void);  
 
+  // evaluation started/done
+  void NotifyScriptPending(bool pending);
+  void NotifyScriptDone(QString err);
+
+  // profile available
+  void NotifyProfile(void);
+
+protected slots:
+
+  // evaluation done
+  void ScriptDone(QString err);
+
 protected:
 
   // typed version of faudes object
@@ -132,6 +160,12 @@ protected:
   // default layout
   VioLuaFunctionLayout* mUserLayout;
 
+  // pending evaluation
+  VioLuaExecute* mpExecute;
+
+  // last profile
+  VioLuaProfile mProfile;
+
 };
 
 
@@ -204,6 +238,8 @@ public:
   // my actions
   QAction* TestAction(void) const { return mTestAction; };
   QAction* RunAction(void) const { return mRunAction; };
+  QAction* BatchAction(void) const { return mBatchAction; };
+  QAction* ProfileAction(void) const { return mProfileAction; };
 
 public slots:
 
@@ -232,6 +268,16 @@ public slots:
   // show/hide property view
   void ShowPropertyView(bool on);
 
+  // track evaluation
+  void ScriptPending(bool pending);
+
+  // batch evaluation
+  void BatchDialog(void);
+
+  // profile: show heat, export folded stacks
+  void ProfileDone(void);
+  void ExportProfile(void);
+
 protected:
 
   // update view from model
@@ -258,6 +304,9 @@ protected:
   // my actions
   QAction* mTestAction;
   QAction* mRunAction;
+  QAction* mBatchAction;
+  QAction* mProfileAction;
+  QAction* mExportProfileAction;
   QAction* mFindAction;
   QAction* mAgainAction;
   QAction* mZoomInAction;
@@ -391,39 +440,73 @@ protected:
  ************************************************
 
  A VioLuaExecute is a helper to evaluate
- the lua code in a seperate task
+ the lua code by a VioLuaPool worker. It operates on a 
+ copy of the function definition, so that the user may
+ continue to edit. Evaluation is on the global lua state,
+ i.e. the console session, while syntax checks use the 
+ pre-warmed state of a pool worker. Start() returns 
+ immediately and completion is reported by NotifyDone(). 
+ In profiling mode, evaluation is sampled by a VioLuaProfiler.
 
  ************************************************
  ************************************************
  */
 
 // class definition
-class VioLuaExecute : public QThread  {
+class VioLuaExecute : public VioLuaJob  {
 
   Q_OBJECT
 
 public:
 
   // construct/destruct
-  VioLuaExecute(VioLuaFunctionModel* lfnct, bool test=false);
+  VioLuaExecute(VioLuaFunctionModel* lfnct, bool test=false, bool profile=false);
   ~VioLuaExecute(void);
 
+  // start evaluation, call from application (ret 0 on success)
+  int Start(void);
+
+  // access
+  bool Test(void) const { return mTest; };
+  bool Profiling(void) const { return mProfiling; };
+  const QString& ErrString(void) const { return mErrString; };
+  const VioLuaProfile& Profile(void) const { return mProfile; };
+
+  // reimplement job: evaluate on global state
+  virtual bool Global(void) const { return !mTest; };
 
 public slots:
-  // execute, call from application
-  QString Execute(void);
+  // request break
+  void Cancel(void);
 
+signals:
+  // evaluation done (empty string on success)
+  void NotifyDone(QString err);
   
-private:
+private slots:
+  // job finished
+  void Done(void);
 
-  // start() thread calls run
-  void run(void);
+protected:
+
+  // reimplement job: evaluate (worker thread)
+  virtual void Run(faudes::LuaState* pL);
+
+  // syntax check on given state (worker thread)
+  QString SyntaxCheck(faudes::LuaState* pL);
+
+private:
 
   // operation reference
   VioLuaFunctionModel* pLfnct;  
-  faudes::LuaFunctionDefinition* pLFfnct;
+  faudes::LuaFunctionDefinition* mLFfnct;
   bool mTest;
+  bool mProfiling;
   QString mErrString;
+  VioLuaProfile mProfile;
+
+  // progress
+  VioProgressDialog* mProgress;
 };
 
 
@@ -0,0 +1,250 @@
+/* violuaprofile.cpp  - sampling profiler for lua evaluation  */
+
+
+/*
+   Graphical IO for FAU Discrete Event Systems Library (libfaudes)
+
+   Copyright (C) 2010 Thomas Moor
+
+*/
+
+
+//#define FAUDES_DEBUG_VIO_LUA
+
+#include "violuaprofile.h"
+#include "violuastyle.h"
+
+
+/*
+ ************************************************
+ ************************************************
+
+ implementation of VioLuaProfile
+
+ ************************************************
+ ************************************************
+ */
+
+// construct
+VioLuaProfile::VioLuaProfile(void) {
+  Clear();
+}
+
+// clear all
+void VioLuaProfile::Clear(void) {
+  mFunctions.clear();
+  mLines.clear();
+  mStacks.clear();
+  mTime=0;
+  mCTime=0;
+  mWallTime=0;
+  mSamples=0;
+}
+
+// self time per line relative to the hottest line
+QMap<int,qreal> VioLuaProfile::Heat(void) const {
+  QMap<int,qreal> res;
+  qint64 max=0;
+  QMap<int,Entry>::const_iterator lit;
+  for(lit=mLines.begin(); lit!=mLines.end(); ++lit)
+    max=qMax(max,lit.value().mSelf);
+  if(max==0) return res;
+  for(lit=mLines.begin(); lit!=mLines.end(); ++lit)
+    if(lit.value().mSelf>0) res[lit.key()]= (qreal) lit.value().mSelf / max;
+  return res;
+}
+
+// text summary
+QString VioLuaProfile::Summary(int max) const {
+  QString res=QString("profile: %1 ms wall time, %2 ms sampled, %3 ms in C functions, %4 samples\n")
+    .arg(mWallTime/1000).arg(mTime/1000).arg(mCTime/1000).arg(mSamples);
+  // sort functions by self time
+  QMultiMap<qint64,QString> byself;
+  QMap<QString,Entry>::const_iterator fit;
+  for(fit=mFunctions.begin(); fit!=mFunctions.end(); ++fit)
+    byself.insert(fit.value().mSelf,fit.key());
+  QMapIterator<qint64,QString> sit(byself);
+  sit.toBack();
+  for(int i=0; i<max && sit.hasPrevious(); i++) {
+    sit.previous();
+    const Entry& entry=mFunctions[sit.value()];
+    res.append(QString("  %1: self %2 ms, total %3 ms\n")
+      .arg(sit.value()).arg(entry.mSelf/1000.0,0,'f',1).arg(entry.mTotal/1000.0,0,'f',1));
+  }
+  return res;
+}
+
+// write folded stacks, one per line with time in microseconds
+int VioLuaProfile::WriteFolded(const QString& filename) const {
+  QFile file(filename);
+  if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) return 1;
+  QTextStream ts(&file);
+  QMap<QString,qint64>::const_iterator sit;
+  for(sit=mStacks.begin(); sit!=mStacks.end(); ++sit)
+    ts << sit.key() << " " << sit.value() << "\n";
+  ts.flush();
+  if(file.error()!=QFile::NoError) return 1;
+  return 0;
+}
+
+
+/*
+ ************************************************
+ ************************************************
+
+ implementation of VioLuaProfiler
+
+ ************************************************
+ ************************************************
+ */
+
+// static: registry key
+char VioLuaProfiler::msKey=0;
+
+// construct
+VioLuaProfiler::VioLuaProfiler(int count) :
+  pLL(0),
+  mCount(count),
+  mPrevHook(0),
+  mPrevMask(0),
+  mPrevCount(0),
+  mLast(0),
+  mCStart(0),
+  mCDepth(0)
+{
+}
+
+// destruct
+VioLuaProfiler::~VioLuaProfiler(void) {
+  Stop();
+}
+
+// install hook
+void VioLuaProfiler::Start(lua_State* pL) {
+  Stop();
+  if(!pL) return;
+  FD_DQL("VioLuaProfiler::Start()");
+  pLL=pL;
+  // record previous hook for chaining
+  mPrevHook=lua_gethook(pLL);
+  mPrevMask=lua_gethookmask(pLL);
+  mPrevCount=lua_gethookcount(pLL);
+  // register myself
+  lua_pushlightuserdata(pLL,&msKey);
+  lua_pushlightuserdata(pLL,this);
+  lua_rawset(pLL,LUA_REGISTRYINDEX);
+  // reset
+  mProfile.Clear();
+  mCDepth=0;
+  mLast=0;
+  mCStart=0;
+  mTimer.start();
+  // go
+  lua_sethook(pLL,&Hook,LUA_MASKCOUNT | LUA_MASKCALL | LUA_MASKRET | mPrevMask, mCount);
+}
+
+// remove hook
+void VioLuaProfiler::Stop(void) {
+  if(!pLL) return;
+  mProfile.mWallTime=Now();
+  // restore previous hook
+  lua_sethook(pLL,mPrevHook,mPrevMask,mPrevCount);
+  lua_pushlightuserdata(pLL,&msKey);
+  lua_pushnil(pLL);
+  lua_rawset(pLL,LUA_REGISTRYINDEX);
+  pLL=0;
+  FD_DQL("VioLuaProfiler::Stop(): samples #" << mProfile.mSamples);
+}
+
+// time since start
+qint64 VioLuaProfiler::Now(void) const {
+#if QT_VERSION >= 0x040800
+  return mTimer.nsecsElapsed()/1000;
+#else
+  return ((qint64) mTimer.elapsed())*1000;
+#endif
+}
+
+// lua hook (this is the evaluating thread)
+void VioLuaProfiler::Hook(lua_State* pL, lua_Debug* pAr) {
+  // find myself
+  lua_pushlightuserdata(pL,&msKey);
+  lua_rawget(pL,LUA_REGISTRYINDEX);
+  VioLuaProfiler* prof = static_cast<VioLuaProfiler*>(lua_touserdata(pL,-1));
+  lua_pop(pL,1);
+  if(!prof) return;
+  // chain previous hook (count events are passed on at our rate)
+  int mask = (pAr->event==LUA_HOOKTAILRET) ? LUA_MASKRET : (1 << pAr->event);
+  if(prof->mPrevHook && (prof->mPrevMask & mask)) prof->mPrevHook(pL,pAr);
+  switch(pAr->event) {
+  // regular sample (dont charge our own time to the next interval)
+  case LUA_HOOKCOUNT:
+    prof->Sample(pL,prof->Now()-prof->mLast);
+    prof->mLast=prof->Now();
+    break;
+  // entering C: record time
+  case LUA_HOOKCALL:
+    if(prof->mCDepth>0) { prof->mCDepth++; break; }
+    lua_getinfo(pL,"S",pAr);
+    if(pAr->what[0]!='C') break;
+    prof->mCDepth=1;
+    prof->mCStart=prof->Now();
+    break;
+  // leaving C: account for time inside, charge to the calling line while still on the stack
+  case LUA_HOOKRET:
+  case LUA_HOOKTAILRET:
+    if(prof->mCDepth==0) break;
+    if(--prof->mCDepth>0) break;
+    prof->mProfile.mCTime+=prof->Now()-prof->mCStart;
+    prof->Sample(pL,prof->Now()-prof->mLast);
+    prof->mLast=prof->Now();
+    break;
+  default:
+    break;
+  }
+}
+
+// frame name for reports and flame graphs
+static QString VioLuaFrameName(const lua_Debug& ar) {
+  QString name = ar.name ? QString(ar.name) : QString("?");
+  if(ar.what[0]=='C') return "[C] " + name;
+  if(ar.what[0]=='m') return "main";
+  return QString("%1:%2").arg(name).arg(ar.linedefined);
+}
+
+// attribute time to current stack
+void VioLuaProfiler::Sample(lua_State* pL, qint64 dt) {
+  if(dt<=0) return;
+  lua_Debug ar;
+  // the profiled function is the outermost lua frame: only its chunk maps to script lines
+  const char* chunk=0;
+  for(int level=0; lua_getstack(pL,level,&ar); level++) {
+    lua_getinfo(pL,"S",&ar);
+    if(ar.what[0]!='C') chunk=ar.source;
+  }
+  QStringList frames;
+  QSet<QString> funcs;
+  QSet<int> lines;
+  bool topfnct=true;
+  bool topline=true;
+  for(int level=0; lua_getstack(pL,level,&ar); level++) {
+    lua_getinfo(pL,"nSl",&ar);
+    QString fname=VioLuaFrameName(ar);
+    frames.prepend(fname);
+    // per function
+    VioLuaProfile::Entry& fentry=mProfile.mFunctions[fname];
+    if(topfnct) { fentry.mSelf+=dt; fentry.mHits++; }
+    if(!funcs.contains(fname)) { fentry.mTotal+=dt; funcs.insert(fname); }
+    topfnct=false;
+    // per line of the script (not C, not other chunks)
+    if(ar.what[0]=='C' || ar.currentline<=0 || qstrcmp(chunk,ar.source)!=0) continue;
+    VioLuaProfile::Entry& lentry=mProfile.mLines[ar.currentline];
+    if(topline) { lentry.mSelf+=dt; lentry.mHits++; }
+    if(!lines.contains(ar.currentline)) { lentry.mTotal+=dt; lines.insert(ar.currentline); }
+    topline=false;
+  }
+  if(frames.isEmpty()) return;
+  mProfile.mStacks[frames.join(";")]+=dt;
+  mProfile.mTime+=dt;
+  mProfile.mSamples++;
+}
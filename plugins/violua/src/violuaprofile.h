@@ -0,0 +1,157 @@
+/* violuaprofile.h  - sampling profiler for lua evaluation */
+
+
+/*
+   Graphical IO for FAU Discrete Event Systems Library (libfaudes)
+
+   Copyright (C) 2010 Thomas Moor
+
+*/
+
+
+
+#ifndef FAUDES_VIOLUAPROFILE_H
+#define FAUDES_VIOLUAPROFILE_H
+
+// std includes
+#include "libviodes.h"
+
+// lua essentials
+extern "C" {
+#include "lua.h"
+}
+
+
+/*
+ ************************************************
+ ************************************************
+
+ A VioLuaProfile holds the result of a profiling run:
+ self and total time per function and per line of the
+ script, the time spent in C functions, i.e. faudes
+ calls, and the sampled call stacks in folded form.
+ Time spent inside a C function is charged to the
+ calling line when the function returns. Per line records
+ refer to the chunk of the profiled function only. All 
+ times are in microseconds.
+
+ ************************************************
+ ************************************************
+ */
+
+class VioLuaProfile {
+
+public:
+
+  // per function/line record
+  class Entry {
+  public:
+    Entry(void) : mSelf(0), mTotal(0), mHits(0) {};
+    qint64 mSelf;
+    qint64 mTotal;
+    int mHits;
+  };
+
+  // construct
+  VioLuaProfile(void);
+
+  // clear all
+  void Clear(void);
+  bool Empty(void) const { return mSamples==0; };
+
+  // self time per line relative to the hottest line
+  QMap<int,qreal> Heat(void) const;
+
+  // text summary with the hottest functions
+  QString Summary(int max=10) const;
+
+  // write folded stacks for flame graph tools (ret 0 on success)
+  int WriteFolded(const QString& filename) const;
+
+  // data
+  QMap<QString,Entry> mFunctions;
+  QMap<int,Entry> mLines;
+  QMap<QString,qint64> mStacks;
+  qint64 mTime;
+  qint64 mCTime;
+  qint64 mWallTime;
+  int mSamples;
+
+};
+
+
+/*
+ ************************************************
+ ************************************************
+
+ A VioLuaProfiler samples the call stack of a lua
+ state via a debug hook every so many instructions.
+ The time since the previous sample is attributed to
+ the stack found; the time used by the profiler itself
+ is not accounted for. Entry to and exit from C 
+ functions is tracked by a depth counter, to account
+ for the time from call to return of the outermost C
+ function; on return, a sample is taken while the C
+ function is still on the stack. A previously installed
+ hook is chained. Start() and Stop() must be called from the 
+ thread that evaluates. Timing has microsecond
+ resolution with Qt 4.8 and later, millisecond
+ resolution otherwise.
+
+ ************************************************
+ ************************************************
+ */
+
+class VioLuaProfiler {
+
+public:
+
+  // construct/destruct (count: instructions per sample)
+  VioLuaProfiler(int count=1000);
+  ~VioLuaProfiler(void);
+
+  // install/remove hook
+  void Start(lua_State* pLL);
+  void Stop(void);
+
+  // result
+  const VioLuaProfile& Profile(void) const { return mProfile; };
+
+private:
+
+  // lua hook
+  static void Hook(lua_State* pLL, lua_Debug* pAr);
+
+  // attribute time to current stack
+  void Sample(lua_State* pLL, qint64 dt);
+
+  // time since start in microseconds
+  qint64 Now(void) const;
+
+  // registry key
+  static char msKey;
+
+  // lua state and previous hook
+  lua_State* pLL;
+  int mCount;
+  lua_Hook mPrevHook;
+  int mPrevMask;
+  int mPrevCount;
+
+  // timing
+#if QT_VERSION >= 0x040800
+  QElapsedTimer mTimer;
+#else
+  QTime mTimer;
+#endif
+  qint64 mLast;
+  qint64 mCStart;
+  int mCDepth;
+
+  // result
+  VioLuaProfile mProfile;
+
+};
+
+
+#endif
@@ -26,8 +26,12 @@ INCLUDEPATH += $$VIODES_LIBFAUDES/include/lua
 HEADERS      += src/violua.h \
                 src/violuastyle.h \
                 src/violuafunction.h \
-                src/violuacode.h 
+                src/violuacode.h \
+                src/violuabatch.h \
+                src/violuaprofile.h 
 SOURCES      += src/violua.cpp \
                 src/violuastyle.cpp \
                 src/violuafunction.cpp \
-                src/violuacode.cpp
+                src/violuacode.cpp \
+                src/violuabatch.cpp \
+                src/violuaprofile.cpp
@@ -352,7 +352,7 @@ void VioMtcGeneratorConfigView::DoVioUpdate(void) {
   // report
   FD_DQT("VioMtcGeneratorConfigView::DoVioUupdate: color map #" << pMtcGeneratorModel->Layout().ColorMap().size());
   // update completers
-  mColorColumns->setSymbolWorld(1,Configuration()->ColorNames());
+  mColorColumns->setSharedSymbolWorld(1,"VioStyle::ColorNames",Configuration()->ColorNames());
   mColorColumns->setSymbolMode(1,VioSymbol::KnownSymbolsOnly /* | VioSymbol::ComboBox  */ );
   // update colorcolumn: add colormap entries;
   mColorColumns->setDimensions(pMtcGeneratorModel->Layout().ColorList().size(),2);
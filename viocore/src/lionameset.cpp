@@ -33,6 +33,9 @@ LioNameSetModel::LioNameSetModel(VioNameSetModel* nameset) :
   // default dimensions
   mDataColumns=1;
   mFlagColumns=0;
+  mFlagCompact=false;
+  mFlagGeneration=0;
+  mFlagRevision=-1;
   // get flags from config
   InsertFlags(pVioNameSetConfig->mAttribute->AttributeConfiguration()->BooleanProperties());
   // update/resize hook
@@ -72,9 +75,58 @@ void LioNameSetModel::InsertFlags(const QList<VioBooleanProperty>& boolprops) {
     mFlagAddresses.append(i);
   }
   mFlagColumns=mFlagNames.size();
+  mFlagGeneration++;
   FD_DQN("LioNameSetModel::InsertFlags(#" << mFlagColumns << ")");
 }
 
+// flags as one compact column
+void LioNameSetModel::CompactFlags(bool on) {
+  if(mFlagCompact==on) return;
+  mFlagCompact=on;
+  reset();
+}
+
+// flag cache: decode the attribute once per row and generation
+quint64 LioNameSetModel::FlagWord(int row) const {
+  // model edits invalidate all rows (selection changes dont)
+  if(pVioNameSetModel->DataRevision()!=mFlagRevision) {
+    mFlagRevision=pVioNameSetModel->DataRevision();
+    mFlagGeneration++;
+  }
+  if(mFlagCache.size()!=rowCount()) {
+    mFlagCache.fill(0,rowCount());
+    mFlagCacheGen.fill(-1,rowCount());
+  }
+  if(mFlagCacheGen.at(row)==mFlagGeneration) return mFlagCache.at(row);
+  // decode
+  faudes::fType fflags=pVioNameSetModel->Attribute(pVioNameSetModel->At(row)).mFlags;
+  const QList<VioBooleanProperty>& props=pVioNameSetModel->BooleanProperties();
+  quint64 word=0;
+  for(int flagno=0; flagno<mFlagColumns && flagno<64; flagno++) {
+    int prop=mFlagAddresses.at(flagno);
+    if(prop<0 || prop>=props.size()) continue;
+    if(props.at(prop).Test(fflags)) word |= ((quint64) 1) << flagno;
+  }
+  mFlagCache[row]=word;
+  mFlagCacheGen[row]=mFlagGeneration;
+  return word;
+}
+
+// flag cache: test one flag (beyond the word width we ask the model)
+bool LioNameSetModel::FlagTest(int row, int flagno) const {
+  if(flagno>=64) 
+    return pVioNameSetModel->BooleanProperty(pVioNameSetModel->At(row),mFlagAddresses.at(flagno));
+  return (FlagWord(row) >> flagno) & 1;
+}
+
+// flag cache: compact text
+QString LioNameSetModel::FlagText(int row) const {
+  QStringList res;
+  for(int flagno=0; flagno<mFlagColumns; flagno++) 
+    if(FlagTest(row,flagno)) res.append(mFlagNames.at(flagno));
+  return res.join(" ");
+}
+
 
 // tabelmodel: headers
 QVariant LioNameSetModel::headerData(int section, Qt::Orientation orientation, int role) const {
@@ -85,6 +137,7 @@ QVariant LioNameSetModel::headerData(int section, Qt::Orientation orientation, i
   // data header
   if(section==0) return QString(pVioNameSetConfig->mHeader);
   // flags
+  if(mFlagCompact) return QString("Flags");
   int flagno=section-mDataColumns;
   return mFlagNames.at(flagno);
 }
@@ -104,8 +157,7 @@ bool LioNameSetModel::IsSymbol(const QModelIndex& index) {
 
 
 // access names by model index: get
-const QString& LioNameSetModel::Symbol(const QModelIndex& index) {
-  static QString estr;
+QString LioNameSetModel::Symbol(const QModelIndex& index) {
   int row=index.row();
   int col=index.column();
   FD_DQN("LioNameSetModel::Symbol(" << row << ", " << col << ")");
@@ -116,7 +168,7 @@ const QString& LioNameSetModel::Symbol(const QModelIndex& index) {
     return pVioNameSetModel->At(row);
   }
   // return default
-  return estr;
+  return QString();
 }
 
 
@@ -147,6 +199,7 @@ void LioNameSetModel::UpdateResize(void) {
   // bail out on no pending
   if(rowCount()!=0 && rowCount()==mUpdateOldRows && !mUpdateChanged)
     return;
+  mFlagGeneration++;
   // empty or content changed: force reset
   if(rowCount()<=0) {
     reset();
@@ -174,6 +227,7 @@ void LioNameSetModel::UpdateResize(void) {
 // resize hook: update all
 void LioNameSetModel::UpdateAll(void) { 
   FD_DQN("LioNameSetModel::UpdateAll(): rows " << rowCount());
+  mFlagGeneration++;
   QModelIndex index1, index2;
   index1=createIndex(0,0);
   index2=createIndex(rowCount()-1,columnCount()-1);
@@ -192,6 +246,7 @@ void LioNameSetModel::UpdateReset(void) {
 
 // resize hook: update row
 void LioNameSetModel::UpdateRow(int row) { 
+  if(row>=0 && row<mFlagCacheGen.size()) mFlagCacheGen[row]=-1;
   QModelIndex index1, index2;
   index1=createIndex(row,0);
   index2=createIndex(row,columnCount()-1);
@@ -225,6 +280,7 @@ void LioNameSetModel::sort(int column, Qt::SortOrder order) {
     if(order==Qt::AscendingOrder) pVioNameSetModel->SortAscending();
     else pVioNameSetModel->SortDescending();
   }
+  mFlagGeneration++;
   reset();
   // track user edit
   Modified(true);
@@ -234,6 +290,7 @@ void LioNameSetModel::sort(int column, Qt::SortOrder order) {
 // tablemodel: number of columns
 int LioNameSetModel::columnCount(const QModelIndex &parent) const {
   (void) parent;
+  if(mFlagCompact) return mDataColumns+(mFlagColumns>0 ? 1 : 0);
   return mDataColumns+mFlagColumns;
 }
 
@@ -255,7 +312,7 @@ Qt::ItemFlags LioNameSetModel::flags(const QModelIndex &index) const {
     if(col<mDataColumns) 
       defaultFlags |= Qt::ItemIsEditable | Qt::ItemIsSelectable; 
     // faudes flag data ?
-    if(col>=mDataColumns) 
+    if(col>=mDataColumns && !mFlagCompact) 
       defaultFlags |= Qt::ItemIsUserCheckable;
   }
   //FD_DQN("LioNameSetModel::flags(" << this << "): done");
@@ -296,9 +353,7 @@ bool LioNameSetModel::removeRows(int row, int count, const QModelIndex& parent)
   // todo: inefficient "builtin fixmap" for large count
   //remove elements in list model
   beginRemoveRows(parent, row, row+count-1);
-  while(count--) {
-    pVioNameSetModel->RemoveAt(row);
-  }
+  pVioNameSetModel->RemoveRange(row,count);
   endRemoveRows();
   // redraw view
   UpdateAll();
@@ -341,7 +396,7 @@ bool LioNameSetModel::setData(const QModelIndex &index, const QVariant& value, i
     return true;
   }
   //** edit data: faudes flags 
-  if(col >= mDataColumns && role == Qt::CheckStateRole) {
+  if(col >= mDataColumns && role == Qt::CheckStateRole && !mFlagCompact) {
     FD_DQN("LioNameSetModel::setData(...): editing flag at " << row << " " << col);
     if(!pVioNameSetModel->Exists(oname)) return false;
     if(value==Qt::Checked) 
@@ -383,11 +438,12 @@ QVariant LioNameSetModel::data(const QModelIndex &index, int role) const {
     //return VioStyle::Color(VioRed);
     return VioStyle::Color(VioBlack);
   }
+  // retrieve data: faudes flags (compact)
+  if(col >= mDataColumns && role == Qt::DisplayRole && mFlagCompact) 
+    return FlagText(row);
   // retrieve data: faudes flags
-  if(col >= mDataColumns && role == Qt::CheckStateRole) {
-    int flagno = col-mDataColumns;
-    bool bp =  pVioNameSetModel->BooleanProperty(oname,mFlagAddresses.at(flagno));
-    if(bp) return QVariant(Qt::Checked);
+  if(col >= mDataColumns && role == Qt::CheckStateRole && !mFlagCompact) {
+    if(FlagTest(row,col-mDataColumns)) return QVariant(Qt::Checked);
     return QVariant(Qt::Unchecked);
   }
   return QVariant();
@@ -403,6 +459,7 @@ Qt::DropActions LioNameSetModel::supportedDropActions(void) const {
 // drag and drop: supported mime types
 QStringList LioNameSetModel::mimeTypes () const{
   QStringList res = QAbstractItemModel::mimeTypes();
+  res << VioNameSetData::MimeType() << "text/plain";
   foreach(const QString& str, res) 
      { (void) str; FD_DQN("LioNameSetModel::mimeType(): " << VioStyle::StrFromQStr(str));}
   return res;
@@ -452,7 +509,20 @@ bool LioNameSetModel::dropMimeData(const QMimeData *data, Qt::DropAction action,
     reset();
     return true;
   }
-  return false;
+  // foreign data: merge symbols in one pass
+  FD_DQN("LioNameSetModel::dropMimeData(...): do merge");
+  bool res=false;
+  VioData* vdat=pVioNameSetModel->NewData();
+  if(vdat->FromMime(data)==0) {
+    const faudes::NameSet* nset=dynamic_cast<const faudes::NameSet*>(vdat->FaudesObject());
+    if(nset) res=pVioNameSetModel->MergeSet(*nset);
+  }
+  delete vdat;
+  if(res) {
+    Modified(true);
+    reset();
+  }
+  return res;
 }
 
 
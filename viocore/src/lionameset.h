@@ -46,13 +46,17 @@ public:
   // configure faudes flag checkboxes
   void InsertFlags(const QList<VioBooleanProperty>& boolprops);
 
+  // flags as one compact read-only column (default off)
+  void CompactFlags(bool on);
+  bool CompactFlags(void) const { return mFlagCompact; };
+
   // convenience access to model hierarcy
   const faudes::NameSet* NameSet(void) const;
   VioNameSetModel* VioModel(void);
 
   // access faudes items by model index
   bool IsSymbol(const QModelIndex& index);
-  const QString& Symbol(const QModelIndex& index);
+  QString Symbol(const QModelIndex& index);
   QModelIndex ModelIndex(const QString& name);
 
   // reimplement qabstracttable 
@@ -114,6 +118,16 @@ protected:
   QList<int> mFlagAddresses;
   int mDataColumns;
   int mFlagColumns;
+  bool mFlagCompact;
+
+  // flag cache: one bit per flag column, rows valid for the current generation
+  mutable QVector<quint64> mFlagCache;
+  mutable QVector<int> mFlagCacheGen;
+  mutable int mFlagGeneration;
+  mutable int mFlagRevision;
+  quint64 FlagWord(int row) const;
+  bool FlagTest(int row, int flagno) const;
+  QString FlagText(int row) const;
 
   // drag/drop hack
   QByteArray mDragData;
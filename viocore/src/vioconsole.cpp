@@ -16,6 +16,135 @@
 #define FD_WARN(a)
 
 
+/*
+ ************************************************
+ ************************************************
+
+ implementation VioLogRecord
+
+ ************************************************
+ ************************************************
+ */
+
+// classify raw message (counted messages stem from loop callbacks)
+VioLogRecord::Category VioLogRecord::Classify(const std::string& message, bool counted) {
+  if(message.compare(0,7,"FAUDES_")==0) {
+    if(message.compare(0,11,"FAUDES_WARN")==0) return Warn;
+    if(message.compare(0,16,"FAUDES_EXCEPTION")==0) return Exception;
+    if(message.compare(0,15,"FAUDES_PROGRESS")==0) return Progress;
+    if(message.compare(0,15,"FAUDES_LUAPRINT")==0) return LuaPrint;
+    return Debug;
+  }
+  if(message.compare(0,8,"DESTOOL_")==0) return Debug;
+  if(counted) return Progress;
+  return Plain;
+}
+
+// category to index
+int VioLogRecord::Index(Category cat) {
+  int idx=0;
+  int bit=cat;
+  while(bit>1) { bit>>=1; idx++; }
+  return idx;
+}
+
+// index to category
+VioLogRecord::Category VioLogRecord::FromIndex(int idx) {
+  return (Category) (1 << idx);
+}
+
+// category name
+QString VioLogRecord::Name(Category cat) {
+  switch(cat) {
+  case Plain: return "Plain";
+  case Console: return "Console";
+  case LuaPrint: return "LuaPrint";
+  case Progress: return "Progress";
+  case Warn: return "Warn";
+  case Exception: return "Exception";
+  case Debug: return "Debug";
+  default: break;
+  }
+  return "";
+}
+
+
+/*
+ ************************************************
+ ************************************************
+
+ implementation VioLogRing
+
+ ************************************************
+ ************************************************
+ */
+
+// construct
+VioLogRing::VioLogRing(int size) : mTail(0), mHead(0), mDropped(0) {
+  int cap=1;
+  while(cap<size) cap*=2;
+  mCells = new Cell[cap];
+  for(int i=0; i<cap; i++) mCells[i].mSeq=i;
+  mMask=cap-1;
+}
+
+// destruct
+VioLogRing::~VioLogRing(void) {
+  delete[] mCells;
+}
+
+// append (any thread, positions wrap as unsigned)
+bool VioLogRing::Push(VioLogRecord::Category cat, int time, const char* data, int len, int cntnow, int cntdone) {
+  Cell* cell;
+  int pos=mTail.fetchAndAddAcquire(0);
+  for(;;) {
+    cell=&mCells[pos & mMask];
+    int seq=cell->mSeq.fetchAndAddAcquire(0);
+    int dif=(int) ((unsigned) seq - (unsigned) pos);
+    // cell is free: try to claim
+    if(dif==0) {
+      if(mTail.testAndSetOrdered(pos,(int) ((unsigned) pos+1))) break;
+    }
+    // ring is full: drop
+    else if(dif<0) {
+      mDropped.fetchAndAddOrdered(1);
+      return false;
+    }
+    // somebody else was faster
+    pos=mTail.fetchAndAddAcquire(0);
+  }
+  cell->mRecord.mCategory=cat;
+  cell->mRecord.mTime=time;
+  cell->mRecord.mThread=QThread::currentThreadId();
+  cell->mRecord.mText=QByteArray(data,len);
+  cell->mRecord.mCntNow=cntnow;
+  cell->mRecord.mCntDone=cntdone;
+  cell->mSeq.fetchAndStoreRelease((int) ((unsigned) pos+1));
+  return true;
+}
+
+// take all (single consumer)
+int VioLogRing::Drain(QList<VioLogRecord>& rRecords) {
+  int cnt=0;
+  for(;;) {
+    Cell* cell=&mCells[mHead & mMask];
+    int seq=cell->mSeq.fetchAndAddAcquire(0);
+    if((int) ((unsigned) seq - (unsigned) (mHead+1)) < 0) break;
+    rRecords.append(cell->mRecord);
+    cell->mRecord.mText=QByteArray();
+    cell->mSeq.fetchAndStoreRelease((int) ((unsigned) mHead+mMask+1));
+    mHead=(int) ((unsigned) mHead+1);
+    cnt++;
+  }
+  return cnt;
+}
+
+// dropped messages
+int VioLogRing::Dropped(void) const {
+  return mDropped;
+}
+
+
 /*
  ************************************************
  ************************************************
@@ -30,9 +159,25 @@
 VioFaudesLogger* VioFaudesLogger::mpVInstance = NULL;
 
 // construct
-VioFaudesLogger::VioFaudesLogger(QObject* parent)  : QObject(parent), ConsoleOut() {
+VioFaudesLogger::VioFaudesLogger(QObject* parent)  : QObject(parent), ConsoleOut(), mDroppedReported(0) {
   FD_WARN("VioConsoleLogger(): construct/install: violog at " << 
      this << " faudes at " << faudes::ConsoleOut::G());
+  // default throttling: progress once per second, no debug
+  mClock.start();
+  for(int i=0; i<VioLogRecord::Count; i++) {
+    mInterval[i]=0;
+    mSample[i]=1;
+    mRecent[i]=-1000000;
+    mSeen[i]=0;
+    mSuppressed[i]=0;
+  }
+  mInterval[VioLogRecord::Index(VioLogRecord::Progress)]=1000;
+  mCapture= VioLogRecord::All & ~VioLogRecord::Debug;
+  // drain at 25 frames per second
+  mFlushTimer = new QTimer(this);
+  mFlushTimer->setInterval(40);
+  connect(mFlushTimer,SIGNAL(timeout()),this,SLOT(Flush()));
+  mFlushTimer->start();
   faudes::ConsoleOut::G()->Redirect(this);
 };
 
@@ -59,114 +204,754 @@ void VioFaudesLogger::Destruct(void) {
 }
   
 
+// configure throttling
+void VioFaudesLogger::RateLimit(VioLogRecord::Category cat, int interval, int sample) {
+  int idx=VioLogRecord::Index(cat);
+  mInterval[idx]=qMax(0,interval);
+  mSample[idx]=qMax(1,sample);
+}
+
+// number of suppressed messages
+int VioFaudesLogger::Suppressed(VioLogRecord::Category cat) const {
+  return mSuppressed[VioLogRecord::Index(cat)];
+}
+
+// throttle (any thread, no locks)
+bool VioFaudesLogger::DoThrottle(VioLogRecord::Category cat, int now) {
+  int idx=VioLogRecord::Index(cat);
+  // sampling
+  int sample=mSample[idx];
+  if(sample>1) {
+    if(mSeen[idx].fetchAndAddRelaxed(1) % sample != 0) {
+      mSuppressed[idx].fetchAndAddRelaxed(1);
+      return false;
+    }
+  }
+  // rate limit (clock wraps after 24h)
+  int interval=mInterval[idx];
+  if(interval>0) {
+    int recent=mRecent[idx];
+    if(now>=recent && now-recent<interval) {
+      mSuppressed[idx].fetchAndAddRelaxed(1);
+      return false;
+    }
+    // somebody else got this slot
+    if(!mRecent[idx].testAndSetOrdered(recent,now)) {
+      mSuppressed[idx].fetchAndAddRelaxed(1);
+      return false;
+    }
+  }
+  return true;
+}
+
 // faudes hook ...
 // ... is rather fragile due to interference between logging and loop call back
 // ... dont use debugging macros FD_xxx here, they will mess up logging
 void VioFaudesLogger::DoWrite(const std::string& message,long int cntnow, long int cntdone) {
-  // initialize my statics
-  static bool doinit=true;
-  static QTime recent;
-  if(doinit) {
-    recent.start();
-    doinit=false;
-  }
-  // conditional logging every 5000ms max
-  if(cntnow!=0 || cntdone !=0) {
-    if(recent.elapsed() < 5000) {
-      //std::cout << "VioFaudesLoggerDoWrite(): swallow ms " << now.secsTo(next) << std::endl;
+  // classify once
+  VioLogRecord::Category cat=VioLogRecord::Classify(message, cntnow!=0 || cntdone!=0);
+  int now=mClock.elapsed();
+  // pass on to base, i.e. std out or file (no throttling)
+  faudes::ConsoleOut::DoWrite(message,cntnow,cntdone);
+  // filter by category
+  if(!(mCapture & cat)) return;
+  // per category throttling of the capture path
+  if(!DoThrottle(cat,now)) return;
+  // pass on via ring buffer, no locks and no events
+  mRing.Push(cat,now,message.data(),message.size(),(int) cntnow,(int) cntdone);
+  // main ui thread: flush now to keep order with direct output
+  if(QApplication::instance()->thread()==QThread::currentThread()) Flush();
+}
+
+// drain ring buffer and emit one notification
+void VioFaudesLogger::Flush(void) {
+  QList<VioLogRecord> records;
+  mRing.Drain(records);
+  int dropped=mRing.Dropped();
+  if(dropped!=mDroppedReported) {
+    VioLogRecord rec;
+    rec.mCategory=VioLogRecord::Warn;
+    rec.mTime=mClock.elapsed();
+    rec.mThread=QThread::currentThreadId();
+    rec.mText=QString("FAUDES_WARN: console: dropped %1 messages\n").arg(dropped-mDroppedReported).toUtf8();
+    rec.mCntNow=0;
+    rec.mCntDone=0;
+    records.append(rec);
+    mDroppedReported=dropped;
+  }
+  if(records.isEmpty()) return;
+  emit NotifyRecords(records);
+}
+
+
+
+/*
+ ************************************************
+ ************************************************
+
+  Implementation: highlighter 
+
+ ************************************************
+ ************************************************
+ */
+
+// static rules
+QVector<VioConsoleHighlighter::HighlightingRule>* VioConsoleHighlighter::msRules = 0;
+
+// construct
+VioConsoleHighlighter::VioConsoleHighlighter(QTextDocument *parent)
+  : QSyntaxHighlighter(parent)
+{
+}
+
+// figure formats for one line
+void VioConsoleHighlighter::Ranges(const QString& text, QList<QTextLayout::FormatRange>& rRanges) {
+
+  // set up rules on first call
+  if(!msRules) {
+    msRules = new QVector<HighlightingRule>();
+
+    QTextCharFormat labelformat;
+    QTextCharFormat redformat;
+    QTextCharFormat promptformat;
+    labelformat.setForeground(VioStyle::Color(VioGrey).light(200));
+    redformat.setForeground(VioStyle::Color(VioRed));
+    promptformat.setForeground(VioStyle::Color(VioBlue));
+
+    HighlightingRule rule;
+
+    rule.pattern = QRegExp("FAUDES_.*:");
+    rule.pattern.setMinimal(true);
+    rule.format = labelformat;
+    msRules->append(rule);
+
+    rule.pattern = QRegExp("FAUDES_WARN:");
+    rule.pattern.setMinimal(true);
+    rule.format = redformat;
+    msRules->append(rule);
+
+    rule.pattern = QRegExp("FAUDES_EXCEPTION:");
+    rule.pattern.setMinimal(true);
+    rule.format = redformat;
+    msRules->append(rule);
+
+    rule.pattern = QRegExp("^> ");
+    rule.pattern.setMinimal(true);
+    rule.format = promptformat;
+    msRules->append(rule);
+  }
+
+  // test rules for std highlighting
+  rRanges.clear();
+  foreach(const HighlightingRule &rule, *msRules) {
+    QRegExp expression(rule.pattern);
+    int index = expression.indexIn(text);
+    while (index >= 0) {
+      int length = expression.matchedLength();
+      QTextLayout::FormatRange range;
+      range.start=index;
+      range.length=length;
+      range.format=rule.format;
+      rRanges.append(range);
+      index = expression.indexIn(text, index + length);
+    }
+  }
+}
+
+// re-implement highlighting
+void VioConsoleHighlighter::highlightBlock(const QString &text) {
+  QList<QTextLayout::FormatRange> ranges;
+  Ranges(text,ranges);
+  foreach(const QTextLayout::FormatRange& range, ranges) 
+    setFormat(range.start, range.length, range.format);
+}
+
+
+
+/*
+ ************************************************
+ ************************************************
+
+ implementation VioLogStore
+
+ ************************************************
+ ************************************************
+ */
+
+// construct
+VioLogStore::VioLogStore(void) : mLines(0), mPartialCategory(VioLogRecord::Plain), mSpill(false), mSpillFile(0) {
+}
+
+// destruct
+VioLogStore::~VioLogStore(void) {
+  Clear();
+}
+
+// clear all
+void VioLogStore::Clear(void) {
+  QMutexLocker lock(&mMutex);
+  foreach(Chunk* chunk, mChunks) {
+    if(chunk->mMap) mSpillFile->unmap(chunk->mMap);
+    delete chunk;
+  }
+  mChunks.clear();
+  mLines=0;
+  mPartial.clear();
+  if(mSpillFile) delete mSpillFile;
+  mSpillFile=0;
+}
+
+// number of lines
+int VioLogStore::Size(void) const {
+  QMutexLocker lock(&mMutex);
+  return mLines + (mPartial.isEmpty() ? 0 : 1);
+}
+
+// number of completed lines
+int VioLogStore::Completed(void) const {
+  QMutexLocker lock(&mMutex);
+  return mLines;
+}
+
+// append text
+void VioLogStore::Append(const QString& text, VioLogRecord::Category cat) {
+  QMutexLocker lock(&mMutex);
+  // the first part of a line determines its category
+  if(mPartial.isEmpty()) mPartialCategory=cat;
+  int start=0;
+  for(;;) {
+    int nl=text.indexOf('\n',start);
+    if(nl<0) {
+      mPartial.append(text.mid(start));
+      break;
+    }
+    mPartial.append(text.mid(start,nl-start));
+    DoAppendLine(mPartial,mPartialCategory);
+    mPartialCategory=cat;
+    mPartial.clear();
+    start=nl+1;
+  }
+}
+
+// append one complete line (lock held)
+void VioLogStore::DoAppendLine(const QString& line, char cat) {
+  // have a chunk with space
+  if(mChunks.isEmpty() || mChunks.last()->mOffsets.size()>=msChunkLines) {
+    if(!mChunks.isEmpty()) DoSpill(mChunks.last());
+    Chunk* chunk = new Chunk();
+    chunk->mOffsets.reserve(msChunkLines);
+    chunk->mCategories.reserve(msChunkLines);
+    chunk->mMap=0;
+    chunk->mSize=0;
+    mChunks.append(chunk);
+  }
+  // append
+  Chunk* chunk=mChunks.last();
+  chunk->mOffsets.append(chunk->mData.size());
+  chunk->mCategories.append(cat);
+  chunk->mData.append(line.toUtf8());
+  mLines++;
+}
+
+// move full chunk to spill file (lock held)
+void VioLogStore::DoSpill(Chunk* chunk) {
+  if(!mSpill) return;
+  if(chunk->mMap) return;
+  // have a file
+  if(!mSpillFile) {
+    mSpillFile = new QTemporaryFile(QDir::tempPath() + QDir::separator() + "vioconsole_XXXXXX");
+    if(!mSpillFile->open()) {
+      FD_WARN("VioLogStore::DoSpill(): cannot open spill file");
+      delete mSpillFile;
+      mSpillFile=0;
+      mSpill=false;
       return;
     }
   }
-  //std::cout << "VioFaudesLoggerDoWrite(): #" << message.size() << std::endl;
-  // pass on to base, i.e. std out or file
-  faudes::ConsoleOut::DoWrite(message,cntnow,cntdone);
+  // write and map (we keep the chunk in memory on failure)
+  qint64 pos=mSpillFile->size();
+  int size=chunk->mData.size();
+  if(size==0) return;
+  if(!mSpillFile->seek(pos)) return;
+  if(mSpillFile->write(chunk->mData)!=size) return;
+  mSpillFile->flush();
+  uchar* map=mSpillFile->map(pos,size);
+  if(!map) return;
+  chunk->mMap=map;
+  chunk->mSize=size;
+  chunk->mData=QByteArray();
+}
 
-  // filter
-  QString qmessage=VioStyle::QStrFromStr(message);
-  bool in=true;
-  if(qmessage.startsWith("FAUDES_")) in=false;
-  if(qmessage.startsWith("DESTOOL_")) in=false;
-  if(qmessage.startsWith("FAUDES_WARN")) in=true;
-  else if(qmessage.startsWith("FAUDES_EXCEPTION")) in=true;
-  else if(qmessage.startsWith("FAUDES_PROGRESS")) in=true;
-  else if(qmessage.startsWith("FAUDES_LUAPRINT")) in=true;
-  if(!in) return;
+// enable spill file
+void VioLogStore::Spill(bool on) {
+  QMutexLocker lock(&mMutex);
+  mSpill=on;
+  if(!mSpill) return;
+  for(int i=0; i+1<mChunks.size(); i++) 
+    DoSpill(mChunks.at(i));
+}
 
-  // note: we must ensure to filter out stuff from non-qt threads
-  // since they block the queue; e.g. iodevice background thread
+// read one line (lock held)
+QString VioLogStore::DoLine(int pos) const {
+  if(pos<0) return QString();
+  if(pos>=mLines) return pos==mLines ? mPartial : QString();
+  const Chunk* chunk=mChunks.at(pos / msChunkLines);
+  int idx=pos % msChunkLines;
+  const char* data = chunk->mMap ? (const char*) chunk->mMap : chunk->mData.constData();
+  int size = chunk->mMap ? chunk->mSize : chunk->mData.size();
+  int beg=chunk->mOffsets.at(idx);
+  int end= idx+1 < chunk->mOffsets.size() ? chunk->mOffsets.at(idx+1) : size;
+  return QString::fromUtf8(data+beg,end-beg);
+}
 
-  // figure whether this is the main ui thread
-  bool inui = (QApplication::instance()->thread()==QThread::currentThread());
+// read one line
+QString VioLogStore::Line(int pos) const {
+  QMutexLocker lock(&mMutex);
+  return DoLine(pos);
+}
 
-  // use std signal when in main ui thread
-  if(inui) emit NotifyAppend(qmessage);
-  // use alternative signal when called from different thread
-  else emit NotifyAltAppend(qmessage);
-  // treat timer
-  recent.restart();
+// read range of lines
+void VioLogStore::Lines(int first, int count, QStringList& rLines, QByteArray* pCategories) const {
+  QMutexLocker lock(&mMutex);
+  rLines.clear();
+  int size=mLines + (mPartial.isEmpty() ? 0 : 1);
+  if(first<0) { count+=first; first=0; }
+  int last=qMin(first+count,size);
+  for(int pos=first; pos<last; pos++) 
+    rLines.append(DoLine(pos));
+  if(pCategories) DoCategories(first,last-first,*pCategories);
 }
 
+// read range of categories
+void VioLogStore::Categories(int first, int count, QByteArray& rCategories) const {
+  QMutexLocker lock(&mMutex);
+  DoCategories(first,count,rCategories);
+}
+
+// read range of categories (lock held)
+void VioLogStore::DoCategories(int first, int count, QByteArray& rCategories) const {
+  rCategories.clear();
+  int size=mLines + (mPartial.isEmpty() ? 0 : 1);
+  if(first<0) { count+=first; first=0; }
+  int last=qMin(first+count,size);
+  for(int pos=first; pos<last; ) {
+    // partial line
+    if(pos==mLines) {
+      rCategories.append(mPartialCategory);
+      break;
+    }
+    // copy from chunk
+    const Chunk* chunk=mChunks.at(pos / msChunkLines);
+    int idx=pos % msChunkLines;
+    int cnt=qMin(last-pos,chunk->mCategories.size()-idx);
+    rCategories.append(chunk->mCategories.constData()+idx,cnt);
+    pos+=cnt;
+  }
+}
 
 
 /*
  ************************************************
  ************************************************
 
-  Implementation: highlighter 
+ implementation VioLogSearch
 
  ************************************************
  ************************************************
  */
 
 // construct
-VioConsoleHighlighter::VioConsoleHighlighter(QTextDocument *parent)
-  : QSyntaxHighlighter(parent)
+VioLogSearch::VioLogSearch(const VioLogStore* store, QObject* parent) :
+  QThread(parent),
+  pStore(store),
+  mCase(Qt::CaseInsensitive),
+  mMask(VioLogRecord::All),
+  mFrom(0),
+  mTarget(0),
+  mCancel(0),
+  mScanned(0)
 {
+}
 
-  mLabelFormat.setForeground(VioStyle::Color(VioGrey).light(200));
-  mRedFormat.setForeground(VioStyle::Color(VioRed));
-  mPromptFormat.setForeground(VioStyle::Color(VioBlue));
+// destruct
+VioLogSearch::~VioLogSearch(void) {
+  Cancel();
+}
 
-  HighlightingRule rule;
+// start scan
+void VioLogSearch::Start(const QString& pattern, Qt::CaseSensitivity cs, int from, int mask) {
+  Cancel();
+  mPattern=pattern;
+  mCase=cs;
+  mMask=mask;
+  mFrom=from;
+  mTarget=pStore->Completed();
+  QMutexLocker lock(&mMutex);
+  if(from==0) mMatches.clear();
+  mScanned=from;
+  mCancel=0;
+  start(QThread::LowPriority);
+}
 
-  rule.pattern = QRegExp("FAUDES_.*:");
-  rule.pattern.setMinimal(true);
-  rule.format = mLabelFormat;
-  mHighlightingRules.append(rule);
+// stop scan
+void VioLogSearch::Cancel(void) {
+  mCancel=1;
+  wait();
+}
 
-  rule.pattern = QRegExp("FAUDES_WARN:");
-  rule.pattern.setMinimal(true);
-  rule.format = mRedFormat;
-  mHighlightingRules.append(rule);
+// access results
+int VioLogSearch::Scanned(void) const {
+  QMutexLocker lock(&mMutex);
+  return mScanned;
+}
 
-  rule.pattern = QRegExp("FAUDES_EXCEPTION:");
-  rule.pattern.setMinimal(true);
-  rule.format = mRedFormat;
-  mHighlightingRules.append(rule);
+// access results
+int VioLogSearch::Count(void) const {
+  QMutexLocker lock(&mMutex);
+  return mMatches.size();
+}
 
-  rule.pattern = QRegExp("^> ");
-  rule.pattern.setMinimal(true);
-  rule.format = mPromptFormat;
-  mHighlightingRules.append(rule);
+// nearest match
+int VioLogSearch::Match(int from, bool backward, bool& rFinal) const {
+  QMutexLocker lock(&mMutex);
+  bool done = mScanned>=mTarget;
+  int res=-1;
+  if(!backward) {
+    QVector<int>::const_iterator mit=qUpperBound(mMatches.begin(),mMatches.end(),from);
+    if(mit!=mMatches.end()) res=*mit;
+    rFinal= done || res>=0;
+  } else {
+    QVector<int>::const_iterator mit=qLowerBound(mMatches.begin(),mMatches.end(),from);
+    if(mit!=mMatches.begin()) res=*(mit-1);
+    rFinal= done || mScanned>=from;
+  }
+  return res;
+}
 
+// run (this is the thread itself, called by start()
+void VioLogSearch::run(void) {
+  FD_DQT("VioLogSearch::run(): from #" << mFrom << " to #" << mTarget);
+  QStringMatcher matcher(mPattern,mCase);
+  QStringList lines;
+  QByteArray cats;
+  QTime recent;
+  recent.start();
+  int pos=mFrom;
+  while(pos<mTarget && mCancel==0) {
+    // scan a block
+    int cnt=qMin(1024,mTarget-pos);
+    pStore->Lines(pos,cnt,lines,&cats);
+    QVector<int> found;
+    for(int i=0; i<lines.size(); i++) {
+      if(!(cats.at(i) & mMask)) continue;
+      if(matcher.indexIn(lines.at(i))>=0) found.append(pos+i);
+    }
+    pos+=cnt;
+    // record
+    int matches;
+    {
+      QMutexLocker lock(&mMutex);
+      bool first=mMatches.isEmpty() && !found.isEmpty();
+      mMatches+=found;
+      mScanned=pos;
+      matches=mMatches.size();
+      if(!first && pos<mTarget && recent.elapsed()<40) continue;
+    }
+    // report, max 25 per second
+    recent.restart();
+    emit NotifyProgress(pos,matches);
+  }
+  FD_DQT("VioLogSearch::run(): done");
 }
 
-// re-implement highlighting
-void VioConsoleHighlighter::highlightBlock(const QString &text) {
 
-  // test rules for std highlighting
-  foreach(const HighlightingRule &rule, mHighlightingRules) {
-    QRegExp expression(rule.pattern);
-    int index = expression.indexIn(text);
-    while (index >= 0) {
-      int length = expression.matchedLength();
-      setFormat(index, length, rule.format);
-      index = expression.indexIn(text, index + length);
+/*
+ ************************************************
+ ************************************************
+
+ implementation VioLogView
+
+ ************************************************
+ ************************************************
+ */
+
+// construct
+VioLogView::VioLogView(QWidget* parent) : 
+  QAbstractScrollArea(parent),
+  mMaxWidth(0),
+  mFilter(VioLogRecord::All),
+  mRowsScanned(0),
+  mSelAnchor(-1),
+  mSelCurrent(-1),
+  mFindCase(Qt::CaseInsensitive),
+  mFindFrom(-1),
+  mFindDirection(0)
+{
+  // text appearance
+  QFont font;
+  font.setFamily("Courier");
+  font.setFixedPitch(true);
+  setFont(font);
+  viewport()->setCursor(Qt::IBeamCursor);
+  // search
+  mSearch = new VioLogSearch(&mStore,this);
+  connect(mSearch,SIGNAL(NotifyProgress(int,int)),this,SLOT(FindResolve()));
+  connect(mSearch,SIGNAL(finished()),this,SLOT(FindResolve()));
+  UpdateScrollBars();
+}
+
+// destruct
+VioLogView::~VioLogView(void) {
+  mSearch->Cancel();
+}
+
+// number of rows
+int VioLogView::Rows(void) const {
+  if(mFilter==VioLogRecord::All) return mStore.Size();
+  return mRows.size();
+}
+
+// map row to line
+int VioLogView::RowToLine(int row) const {
+  if(mFilter==VioLogRecord::All) return row;
+  if(row<0) return -1;
+  if(row>=mRows.size()) return mStore.Size();
+  return mRows.at(row);
+}
+
+// map line to row (first row at or after line)
+int VioLogView::LineToRow(int line) const {
+  if(mFilter==VioLogRecord::All) return line;
+  return qLowerBound(mRows.begin(),mRows.end(),line) - mRows.begin();
+}
+
+// extend row index to new lines
+void VioLogView::UpdateRows(void) {
+  if(mFilter==VioLogRecord::All) return;
+  int size=mStore.Size();
+  if(mRowsScanned>=size) return;
+  QByteArray cats;
+  mStore.Categories(mRowsScanned,size-mRowsScanned,cats);
+  for(int i=0; i<cats.size(); i++) 
+    if(cats.at(i) & mFilter) mRows.append(mRowsScanned+i);
+  mRowsScanned=size;
+}
+
+// set filter
+void VioLogView::Filter(int mask) {
+  mask &= VioLogRecord::All;
+  if(mask==mFilter) return;
+  FD_DQH("VioLogView::Filter(" << mask << ")");
+  QScrollBar* vsb=verticalScrollBar();
+  bool follow = vsb->value()==vsb->maximum();
+  int top=RowToLine(vsb->value());
+  // rebuild index
+  mFilter=mask;
+  mRows.clear();
+  mRowsScanned=0;
+  UpdateRows();
+  UpdateScrollBars();
+  // keep position
+  if(follow) vsb->setValue(vsb->maximum());
+  else vsb->setValue(LineToRow(top));
+  viewport()->update();
+}
+
+// line geometry
+int VioLogView::LineHeight(void) const {
+  return qMax(1,fontMetrics().lineSpacing());
+}
+
+// line geometry
+int VioLogView::VisibleLines(void) const {
+  return qMax(1,viewport()->height()/LineHeight());
+}
+
+// line geometry
+int VioLogView::LineAt(int y) const {
+  int row=verticalScrollBar()->value() + y/LineHeight();
+  return RowToLine(qBound(0,row,qMax(0,Rows()-1)));
+}
+
+// adjust scrollbars
+void VioLogView::UpdateScrollBars(void) {
+  int vis=VisibleLines();
+  verticalScrollBar()->setRange(0,qMax(0,Rows()-vis));
+  verticalScrollBar()->setPageStep(vis);
+  verticalScrollBar()->setSingleStep(1);
+  horizontalScrollBar()->setRange(0,qMax(0,mMaxWidth-viewport()->width()+10));
+  horizontalScrollBar()->setPageStep(viewport()->width());
+  horizontalScrollBar()->setSingleStep(fontMetrics().width('x'));
+}
+
+// append text
+void VioLogView::Append(const QString& text, VioLogRecord::Category cat) {
+  QScrollBar* vsb=verticalScrollBar();
+  bool follow = vsb->value()==vsb->maximum() && !vsb->isSliderDown();
+  mStore.Append(text,cat);
+  UpdateRows();
+  UpdateScrollBars();
+  if(follow) vsb->setValue(vsb->maximum());
+  viewport()->update();
+}
+
+// clear all
+void VioLogView::Clear(void) {
+  mSearch->Cancel();
+  mStore.Clear();
+  mRows.clear();
+  mRowsScanned=0;
+  mFindPattern="";
+  mFindDirection=0;
+  mSelAnchor=-1;
+  mSelCurrent=-1;
+  mMaxWidth=0;
+  UpdateScrollBars();
+  viewport()->update();
+}
+
+// copy selected lines
+void VioLogView::Copy(void) {
+  if(mSelAnchor<0) return;
+  int first=qMin(mSelAnchor,mSelCurrent);
+  int last=qMax(mSelAnchor,mSelCurrent);
+  QStringList lines;
+  QByteArray cats;
+  mStore.Lines(first,last-first+1,lines,&cats);
+  QStringList res;
+  for(int i=0; i<lines.size(); i++) 
+    if(cats.at(i) & mFilter) res.append(lines.at(i));
+  QApplication::clipboard()->setText(res.join("\n"));
+}
+
+// find
+void VioLogView::Find(const QString& pattern, QTextDocument::FindFlags flags) {
+  FD_DQH("VioLogView::Find(" << VioStyle::StrFromQStr(pattern) << ")");
+  if(pattern=="") return;
+  Qt::CaseSensitivity cs = (flags & QTextDocument::FindCaseSensitively) ? 
+    Qt::CaseSensitive : Qt::CaseInsensitive;
+  bool backward = flags & QTextDocument::FindBackward;
+  // new pattern or filter: restart scan
+  if(pattern!=mFindPattern || cs!=mFindCase || mFilter!=mSearch->Mask()) {
+    mFindPattern=pattern;
+    mFindCase=cs;
+    mSearch->Start(mFindPattern,mFindCase,0,mFilter);
+  }
+  // same pattern: extend scan to new lines
+  else if(!mSearch->isRunning() && mSearch->Scanned()<mStore.Completed()) {
+    mSearch->Start(mFindPattern,mFindCase,mSearch->Scanned(),mFilter);
+  }
+  // figure start position (lines)
+  int top=verticalScrollBar()->value();
+  if(flags & 0x1000) 
+    mFindFrom = backward ? mStore.Size() : -1;
+  else if(mSelAnchor>=0) 
+    mFindFrom = mSelCurrent;
+  else 
+    mFindFrom = backward ? RowToLine(top+VisibleLines()) : RowToLine(top)-1;
+  mFindDirection = backward ? -1 : 1;
+  // resolve now or when the scan makes progress
+  FindResolve();
+}
+
+// jump to match once known
+void VioLogView::FindResolve(void) {
+  if(mFindDirection==0) return;
+  bool final;
+  int line=mSearch->Match(mFindFrom,mFindDirection<0,final);
+  if(!final) return;
+  mFindDirection=0;
+  if(line<0) return;
+  // select and center
+  mSelAnchor=line;
+  mSelCurrent=line;
+  verticalScrollBar()->setValue(LineToRow(line)-VisibleLines()/2);
+  viewport()->update();
+}
+
+// paint visible lines only
+void VioLogView::paintEvent(QPaintEvent* event) {
+  (void) event;
+  QPainter painter(viewport());
+  painter.setPen(palette().color(QPalette::Text));
+  int lh=LineHeight();
+  int first=verticalScrollBar()->value();
+  int xoff=2-horizontalScrollBar()->value();
+  int selfirst=qMin(mSelAnchor,mSelCurrent);
+  int sellast=qMax(mSelAnchor,mSelCurrent);
+  // fetch visible lines
+  QStringList lines;
+  QVector<int> lnos;
+  int count=VisibleLines()+1;
+  if(mFilter==VioLogRecord::All) {
+    mStore.Lines(first,count,lines);
+    for(int i=0; i<lines.size(); i++) lnos.append(first+i);
+  } else {
+    for(int row=first; row<first+count && row<mRows.size(); row++) {
+      lnos.append(mRows.at(row));
+      lines.append(mStore.Line(mRows.at(row)));
     }
   }
+  // draw
+  QTextOption option;
+  option.setWrapMode(QTextOption::NoWrap);
+  int width=mMaxWidth;
+  for(int i=0; i<lines.size(); i++) {
+    int y=i*lh;
+    // selection background
+    if(mSelAnchor>=0 && lnos.at(i)>=selfirst && lnos.at(i)<=sellast)
+      painter.fillRect(0,y,viewport()->width(),lh,palette().color(QPalette::Highlight).light(160));
+    // layout and highlight this line
+    QTextLayout layout(lines.at(i),font());
+    QList<QTextLayout::FormatRange> ranges;
+    VioConsoleHighlighter::Ranges(lines.at(i),ranges);
+    layout.setAdditionalFormats(ranges);
+    layout.setTextOption(option);
+    layout.beginLayout();
+    QTextLine tline=layout.createLine();
+    if(tline.isValid()) tline.setLineWidth(1e6);
+    layout.endLayout();
+    layout.draw(&painter,QPointF(xoff,y));
+    if(tline.isValid()) width=qMax(width,(int) tline.naturalTextWidth());
+  }
+  // adjust horizontal range after painting
+  if(width>mMaxWidth) {
+    mMaxWidth=width;
+    QMetaObject::invokeMethod(this,"UpdateScrollBars",Qt::QueuedConnection);
+  }
+}
 
+// track size
+void VioLogView::resizeEvent(QResizeEvent* event) {
+  QAbstractScrollArea::resizeEvent(event);
+  UpdateScrollBars();
 }
 
+// select lines
+void VioLogView::mousePressEvent(QMouseEvent* event) {
+  if(event->button()!=Qt::LeftButton) return;
+  if(Rows()==0) return;
+  mSelAnchor=LineAt(event->pos().y());
+  mSelCurrent=mSelAnchor;
+  viewport()->update();
+}
+
+// select lines
+void VioLogView::mouseMoveEvent(QMouseEvent* event) {
+  if(!(event->buttons() & Qt::LeftButton)) return;
+  if(mSelAnchor<0) return;
+  mSelCurrent=LineAt(event->pos().y());
+  viewport()->update();
+}
+
+// keys
+void VioLogView::keyPressEvent(QKeyEvent* event) {
+  if(event->matches(QKeySequence::Copy)) {
+    Copy();
+    return;
+  }
+  QAbstractScrollArea::keyPressEvent(event);
+}
 
 
 
@@ -204,11 +989,20 @@ VioConsoleWidget::VioConsoleWidget(QWidget* parent) : QWidget(parent) {
   // highlighter
   VioConsoleHighlighter* highlighter = new VioConsoleHighlighter(mConsoleText->document());
   (void) highlighter;
+  // paged output
+  mLogView = new VioLogView();
+  mLogView->setContextMenuPolicy(Qt::CustomContextMenu);
+  connect(mLogView,SIGNAL(customContextMenuRequested(const QPoint&)),this,SLOT(FilterMenu(const QPoint&)));
+  mpEvaluate=0;
+  mPaged=false;
+  mFilter=VioLogRecord::All;
   // my layout
   mVbox = new QVBoxLayout(this);
   mVbox->setMargin(0);
   mVbox->setSpacing(5);
+  mVbox->addWidget(mLogView);
   mVbox->addWidget(mConsoleText);
+  Paged(true);
   // appearance
   setMinimumWidth(600);
   setMinimumHeight(200);
@@ -217,27 +1011,101 @@ VioConsoleWidget::VioConsoleWidget(QWidget* parent) : QWidget(parent) {
   // instantiage logger
   VioFaudesLogger::G();
   // connect to logger
-  connect(VioFaudesLogger::G(),SIGNAL(NotifyAppend(QString)), this, SLOT(AppendFaudes(QString)));
-  connect(VioFaudesLogger::G(),SIGNAL(NotifyAltAppend(QString)), this, SLOT(AppendFaudes(QString)),Qt::BlockingQueuedConnection);
+  connect(VioFaudesLogger::G(),SIGNAL(NotifyRecords(const QList<VioLogRecord>&)), 
+    this, SLOT(AppendRecords(const QList<VioLogRecord>&)));
+  // set up global lua state once per session
+  VioLuaPool::G()->Warmup();
 }
 
 // destruct
 VioConsoleWidget::~VioConsoleWidget(void) {
   FD_WARN("VioConsoleWidget(): detsruct");
+  // wait for pending evaluation
+  if(mpEvaluate) {
+    mpEvaluate->Cancel();
+    mpEvaluate->Withdraw();
+  }
   // destruct logger
   VioFaudesLogger::Destruct();
 }
 
-// configure
+// configure (text edit only, paged scrollback is unlimited)
 void VioConsoleWidget::BufferSize(int max) {
   mConsoleText->setMaximumBlockCount(max); 
 }
 
+// configure paged mode
+void VioConsoleWidget::Paged(bool on) {
+  if(on==mPaged) return;
+  mPaged=on;
+  mLogView->setVisible(mPaged);
+  // prompt only
+  if(mPaged) {
+    QFontMetrics fm(mConsoleText->font());
+    mConsoleText->setMaximumHeight(3*fm.lineSpacing() + 2*mConsoleText->frameWidth() + 8);
+  } else {
+    mConsoleText->setMaximumHeight(QWIDGETSIZE_MAX);
+  }
+  Clear();
+}
+
+// configure filter
+void VioConsoleWidget::Filter(int mask) {
+  mFilter=mask & VioLogRecord::All;
+  mLogView->Filter(mFilter);
+}
+
+// context menu: filter by category
+void VioConsoleWidget::FilterMenu(const QPoint& pos) {
+  QMenu* menu = new QMenu("Show");
+  QList<QAction*> cataction;
+  for(int i=0; i<VioLogRecord::Count; i++) {
+    VioLogRecord::Category cat=VioLogRecord::FromIndex(i);
+    QAction* action= menu->addAction(VioLogRecord::Name(cat));
+    action->setCheckable(true);
+    action->setChecked(mFilter & cat);
+    cataction.append(action);
+  }
+  menu->addSeparator();
+  QAction* allaction= menu->addAction("Show All");
+  QAction* copyaction= menu->addAction("Copy");
+  copyaction->setEnabled(mLogView->HasSelection());
+  // run menu
+  QAction *selaction = menu->exec(mLogView->mapToGlobal(pos));
+  int mask=mFilter;
+  if(selaction==allaction) mask=VioLogRecord::All;
+  if(selaction==copyaction) mLogView->Copy();
+  int idx=cataction.indexOf(selaction);
+  if(idx>=0) mask ^= VioLogRecord::FromIndex(idx);
+  delete menu;
+  // debug output is captured only when shown
+  VioFaudesLogger* logger=VioFaudesLogger::G();
+  if(mask & VioLogRecord::Debug) logger->Capture(logger->Capture() | VioLogRecord::Debug);
+  else logger->Capture(logger->Capture() & ~VioLogRecord::Debug);
+  Filter(mask);
+}
+
+// configure spill file
+void VioConsoleWidget::Spill(bool on) {
+  mLogView->Store()->Spill(on);
+}
+
 // clear all history
 void VioConsoleWidget::Clear(void) {
+  if(mpEvaluate) return;
   mConsoleText->clear();
   mFindPattern="";
   mFindFlags=0;
+  // paged: hello to log, prompt to text edit
+  if(mPaged) {
+    mLogView->Clear();
+    mLogView->Append("libFAUDES console\n",VioLogRecord::Console);
+    mPrePrompt=mConsoleText->textCursor();
+    mPostPrompt=mConsoleText->textCursor();
+    AppendPrompt();
+    mHistoryCurrent=mHistory.size();
+    return;
+  }
   mConsoleText->appendPlainText("libFAUDES console");
   mPrePrompt=mConsoleText->textCursor();
   mPostPrompt=mConsoleText->textCursor();
@@ -274,17 +1142,39 @@ void VioConsoleWidget::RemoveLastLine(void) {
 }
 
 // append faudes message before promt
-void VioConsoleWidget::AppendFaudes(QString message) {
+void VioConsoleWidget::AppendFaudes(QString message, VioLogRecord::Category cat) {
   //std::cout << "VioFaudesLogger::Append(#"<<message.size()<<")" << std::endl;
   // mConsoleText->appendPlainText(message);
   // mConsoleText->moveCursor(QTextCursor::End);
   // mConsoleText->insertPlainText(message);
+  if(mPaged) {
+    mLogView->Append(message,cat);
+    return;
+  }
+  // text edit: filter now
+  if(!(cat & mFilter)) return;
   mPrePrompt.insertText(message);
   mConsoleText->setTextCursor(mPostPrompt);
   if(!mConsoleText->verticalScrollBar()->isSliderDown())
      mConsoleText->ensureCursorVisible();
 }
 
+// append records from logger
+void VioConsoleWidget::AppendRecords(const QList<VioLogRecord>& records) {
+  // paged: pass on per record to keep categories
+  if(mPaged) {
+    foreach(const VioLogRecord& rec, records) 
+      mLogView->Append(QString::fromUtf8(rec.mText.constData(),rec.mText.size()),rec.mCategory);
+    return;
+  }
+  // text edit: filter now, one insert for all
+  QByteArray text;
+  foreach(const VioLogRecord& rec, records) 
+    if(rec.mCategory & mFilter) text.append(rec.mText);
+  if(text.isEmpty()) return;
+  AppendFaudes(QString::fromUtf8(text.constData(),text.size()),VioLogRecord::All);
+}
+
 // append keys
 void VioConsoleWidget::AppendPlain(const QString& txt) {
   // bail out
@@ -334,15 +1224,30 @@ void VioConsoleWidget::Execute(void) {
   if(mHistory.at(mHistory.size()-2)==cmd)
     mHistory.removeLast();
   mHistoryCurrent=mHistory.size();
-  // add new-line
-  AppendNewLine();
-  // have extra thread to evaluate
-  VioConsoleEvaluate* eval= new VioConsoleEvaluate(cmd);
-  QString err= eval->Execute();
+  // add new-line (paged: echo to log and have fresh prompt line)
+  if(mPaged) {
+    mLogView->Append("> "+cmd+"\n",VioLogRecord::Console);
+    mConsoleText->clear();
+    mPrePrompt=mConsoleText->textCursor();
+    mPostPrompt=mConsoleText->textCursor();
+  } else {
+    AppendNewLine();
+  }
+  // have extra thread to evaluate, continue when done
+  mpEvaluate= new VioConsoleEvaluate(cmd,this);
+  connect(mpEvaluate,SIGNAL(NotifyDone(QString)),this,SLOT(EvaluateDone(QString)));
+  mpEvaluate->Start();
+}
+
+// evaluation done
+void VioConsoleWidget::EvaluateDone(QString err) {
+  if(!mpEvaluate) return;
+  mpEvaluate->deleteLater();
+  mpEvaluate=0;
   // Report error, if any
   if(err!="") {
     if(err.startsWith("[string \"string\"]")) err=QString("[line]")+err.mid(17);
-    AppendFaudes(QString("FAUDES_EXCEPTION: ")+err+"\n");
+    AppendFaudes(QString("FAUDES_EXCEPTION: ")+err+"\n",VioLogRecord::Exception);
   }
   // add prompt
   AppendPrompt();
@@ -356,8 +1261,11 @@ void VioConsoleWidget::Complete(void) {
   int wpos=line.indexOf(QRegExp("[a-zA-Z0-9_.:]+$"));
   QString word="";
   if(wpos>=0) word=line.mid(wpos);
-  // get list of completions
+  // get list of completions (skip while a job operates on the global state)
+  QMutex* gmutex=VioLuaPool::G()->GlobalMutex();
+  if(!gmutex->tryLock()) return;
   std::list< std::string > mlist =  faudes::LuaState::G()->Complete(VioStyle::StrFromQStr(word));
+  gmutex->unlock();
   QStringList list;
   std::list< std::string >::iterator lit;
   for(lit=mlist.begin(); lit!=mlist.end();  lit++) 
@@ -376,6 +1284,14 @@ void VioConsoleWidget::Complete(void) {
     default: 
       // print list
       list.sort();
+      if(mPaged) {
+        QString txt;
+        for(int i=1; i<list.size(); i++) txt.append(list.at(i)+"\n");
+        mLogView->Append(txt,VioLogRecord::Console);
+        if(list.at(0).size()>word.size())
+          AppendPlain(list.at(0).mid(word.size()));
+        break;
+      }
       for(int i=1; i<list.size(); i++) {
 	AppendNewLine();
         AppendPlain(list.at(i));
@@ -398,6 +1314,11 @@ bool VioConsoleWidget::eventFilter(QObject *obj, QEvent *event) {
   // keys
   if(event->type() == QEvent::KeyPress) {
     QKeyEvent *e = static_cast<QKeyEvent*>(event);
+    // evaluation pending: escape to cancel, swallow others
+    if(mpEvaluate) {
+      if(e->key() == Qt::Key_Escape) mpEvaluate->Cancel();
+      return true;
+    }
     //std::cout << "Filter key press " << e->key() << std::endl;
     // input a character: we doit
     if(e->key() >= Qt::Key_Space && e->key() <= Qt::Key_AsciiTilde) 
@@ -489,6 +1410,10 @@ void VioConsoleWidget::keyPressEvent(QKeyEvent * e) {
 
 // copy to clippboard
 void VioConsoleWidget::Copy(void) {
+  if(mPaged && !mConsoleText->textCursor().hasSelection() && mLogView->HasSelection()) {
+    mLogView->Copy();
+    return;
+  }
   mConsoleText->copy();
 }
 
@@ -499,6 +1424,7 @@ void VioConsoleWidget::Cut(void) {
 
 // paste from clippboard
 void VioConsoleWidget::Paste(void) {
+  if(mpEvaluate) return;
   // figure clipboard
   const QClipboard *clipboard = QApplication::clipboard();
   QString txt=clipboard->text();
@@ -513,6 +1439,11 @@ void VioConsoleWidget::Find(const QString& pattern, QTextDocument::FindFlags fla
   FD_DQH("VioConsoleWidget::Find(" << VioStyle::StrFromQStr(pattern) << ")");
   mFindPattern=pattern;
   mFindFlags=flags;
+  // paged: search log in background
+  if(mPaged) {
+    mLogView->Find(mFindPattern, mFindFlags & (~ 0xe000));
+    return;
+  }
   // reset position
   if(mFindFlags & 0x1000) {
     if(mFindFlags & QTextDocument::FindBackward)
@@ -540,7 +1471,24 @@ void VioConsoleWidget::FindDialog(void) {
 
 // reset lua state
 void VioConsoleWidget::Reset(void) {
+  if(mpEvaluate) return;
+  // not while a job operates on the global state
+  QMutex* gmutex=VioLuaPool::G()->GlobalMutex();
+  if(!gmutex->tryLock()) {
+    AppendFaudes("FAUDES_WARN: console: lua state busy\n",VioLogRecord::Warn);
+    return;
+  }
   faudes::LuaState::G()->Reset();
+  gmutex->unlock();
+  if(mPaged) {
+    mLogView->Append("Lua Reset\n",VioLogRecord::Console);
+    mConsoleText->clear();
+    mPrePrompt=mConsoleText->textCursor();
+    mPostPrompt=mConsoleText->textCursor();
+    AppendPrompt();
+    mHistoryCurrent=mHistory.size();
+    return;
+  }
   mConsoleText->appendPlainText("Lua Reset");
   mPrePrompt=mConsoleText->textCursor();
   mPostPrompt=mConsoleText->textCursor();
@@ -705,21 +1653,26 @@ QTextDocument::FindFlags VioFindDialog::Flags(void) {
 
 
 // construct/destruct
-VioConsoleEvaluate::VioConsoleEvaluate(QString command) : QThread(0) {
+VioConsoleEvaluate::VioConsoleEvaluate(QString command, QObject* parent) : 
+  VioLuaJob(parent),
+  mProgress(0)
+{
   mCommand=command;
+  connect(this,SIGNAL(finished()),this,SLOT(Done()));
 };
 
 // destruct  
 VioConsoleEvaluate::~VioConsoleEvaluate(void) {
+  Withdraw();
+  if(mProgress) delete mProgress;
 };
 
 
-// run (this is the thread itself, called by start()
-void VioConsoleEvaluate::run(void) {
-  // execute this statment: should go in  a thread ??
+// run (this is the worker thread)
+void VioConsoleEvaluate::Run(faudes::LuaState* pL) {
   mErrStr="";
   try{
-    faudes::LuaState::G()->Evaluate(VioStyle::StrFromQStr(mCommand));
+    pL->Evaluate(VioStyle::StrFromQStr(mCommand));
   } catch( faudes::Exception fex) {
     mErrStr=VioStyle::QStrFromStr(fex.What());
   }
@@ -727,40 +1680,65 @@ void VioConsoleEvaluate::run(void) {
 
 
 // api: this is callers thread
-QString VioConsoleEvaluate::Execute(void) {
-  // install progress dialog
-  QProgressDialog progress("Evaluating", "Cancel", 0, 0, 0); 
-  progress.setWindowModality(Qt::ApplicationModal);
-  progress.setValue(0);
-  QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
-  QApplication::flush();
-  // clear global break flag
-  VioStyle::FaudesBreakClr(); 
-  // run my extra thread
-  start();
-  // process applicationevent loop while running
-  long int i=100; 
-  while(isRunning() && (--i)>0) {
-    QApplication::processEvents(QEventLoop::ExcludeUserInputEvents,10);
-    QApplication::flush();
-    wait(10);
-  }
-  bool canceled=false;
-  while(isRunning()) {
-    QApplication::processEvents(QEventLoop::AllEvents,10);
-    QApplication::flush();
-    if(progress.wasCanceled() && !canceled) {
-       VioStyle::FaudesBreakSet(); 
-       canceled=true;
-    }
-    progress.setValue(1); 
-    wait(10);
-  }
-  // clear global break flag
-  VioStyle::FaudesBreakClr(); 
+void VioConsoleEvaluate::Start(void) {
+  // install non-modal progress dialog
+  mProgress = new VioProgressDialog("Evaluating");
+  connect(mProgress,SIGNAL(canceled()),this,SLOT(Cancel()));
+  // pass on to worker pool (resets my cancellation context)
+  Submit();
+}
+
+// api: request break
+void VioConsoleEvaluate::Cancel(void) {
+  if(Pending()) VioLuaJob::Cancel(); 
+}
+
+// job finished (callers thread)
+void VioConsoleEvaluate::Done(void) {
+  if(mProgress) mProgress->deleteLater();
+  mProgress=0;
   // done
-  return mErrStr;
+  emit NotifyDone(mErrStr);
 }
 
 
+/*
+ ************************************************
+ ************************************************
+
+ implementation of VioProgressDialog
 
+ ************************************************
+ ************************************************
+ */
+
+// construct
+VioProgressDialog::VioProgressDialog(const QString& label, QWidget* parent) : 
+  QProgressDialog(label, "Cancel", 0, 0, parent),
+  mLabel(label)
+{
+  setWindowModality(Qt::NonModal);
+  setMinimumDuration(500);
+  setValue(0);
+  connect(VioFaudesLogger::G(),SIGNAL(NotifyRecords(const QList<VioLogRecord>&)), 
+    this, SLOT(Records(const QList<VioLogRecord>&)));
+}
+
+// track progress records
+void VioProgressDialog::Records(const QList<VioLogRecord>& records) {
+  // find most recent progress
+  int pos=records.size()-1;
+  for(; pos>=0; pos--) 
+    if(records.at(pos).mCategory==VioLogRecord::Progress) break;
+  if(pos<0) return;
+  const VioLogRecord& rec=records.at(pos);
+  // label
+  QString msg=QString::fromUtf8(rec.mText.constData(),rec.mText.size()).simplified();
+  if(msg.startsWith("FAUDES_PROGRESS:")) msg=msg.mid(16).trimmed();
+  if(msg!="") setLabelText(mLabel + ": " + msg);
+  // range
+  if(rec.mCntDone>0) {
+    setRange(0,rec.mCntDone);
+    setValue(qMin(rec.mCntNow,rec.mCntDone));
+  }
+}
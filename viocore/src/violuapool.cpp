@@ -0,0 +1,360 @@
+/* violuapool.cpp  - pool of lua interpreter threads  */
+
+
+/*
+   Graphical IO for FAU Discrete Event Systems Library (libfaudes)
+
+   Copyright (C) 2010 Thomas Moor
+
+*/
+
+#include "violuapool.h"
+
+
+/*
+ ************************************************
+ ************************************************
+
+ implementation of VioLuaJob
+
+ ************************************************
+ ************************************************
+ */
+
+// construct
+VioLuaJob::VioLuaJob(QObject* parent) :
+  QObject(parent),
+  mPending(false)
+{
+}
+
+// destruct (derived classes should have withdrawn already)
+VioLuaJob::~VioLuaJob(void) {
+  if(Pending()) VioLuaPool::G()->Withdraw(this);
+}
+
+// queue for evaluation
+void VioLuaJob::Submit(void) {
+  VioLuaPool::G()->Submit(this);
+}
+
+// queued or running
+bool VioLuaJob::Pending(void) const {
+  return VioLuaPool::G()->Pending(this);
+}
+
+// take from queue or wait
+void VioLuaJob::Withdraw(void) {
+  if(!Pending()) return;
+  VioLuaPool::G()->Withdraw(this);
+}
+
+// request break
+void VioLuaJob::Cancel(void) {
+  mContext.Cancel();
+}
+
+// take from queue if not yet running
+int VioLuaJob::Dequeue(void) {
+  if(!Pending()) return 1;
+  return VioLuaPool::G()->Dequeue(this);
+}
+
+
+/*
+ ************************************************
+ ************************************************
+
+ implementation of VioLuaWorker
+
+ ************************************************
+ ************************************************
+ */
+
+// lua code to record globals and to provide the restore function;
+// we keep library functions in locals, so scripts cannot mess them up
+static const char* VioLuaSnapshot=
+  "do\n"
+  "  local pairs, rawset, getmetatable, setmetatable = pairs, rawset, getmetatable, setmetatable\n"
+  "  local g, mt = {}, getmetatable(_G)\n"
+  "  for k,v in pairs(_G) do g[k]=v end\n"
+  "  local function restore()\n"
+  "    setmetatable(_G,nil)\n"
+  "    for k in pairs(_G) do if g[k]==nil then rawset(_G,k,nil) end end\n"
+  "    for k,v in pairs(g) do rawset(_G,k,v) end\n"
+  "    setmetatable(_G,mt)\n"
+  "  end\n"
+  "  g.__viorestore=restore\n"
+  "  __viorestore=restore\n"
+  "end\n";
+
+// static: serialise set-up
+QMutex VioLuaWorker::msOpenMutex;
+
+// construct
+VioLuaWorker::VioLuaWorker(VioLuaPool* pool, bool global) :
+  QThread(pool),
+  pPool(pool),
+  mpL(0),
+  mGlobal(global)
+{
+}
+
+// destruct
+VioLuaWorker::~VioLuaWorker(void) {
+  wait();
+  if(mpL && !mGlobal) delete mpL;
+}
+
+// set up lua state (worker thread)
+void VioLuaWorker::Open(void) {
+  QMutexLocker lock(&msOpenMutex);
+  FD_DQ("VioLuaWorker::Open(): global " << mGlobal);
+  // global state: set up once, guarded against the ui thread
+  if(mGlobal) {
+    QMutexLocker glock(pPool->GlobalMutex());
+    mpL = faudes::LuaState::G();
+    return;
+  }
+  if(mpL) delete mpL;
+  // the constructor loads the faudes bindings
+  mpL = new faudes::LuaState();
+  // record globals
+  try {
+    mpL->Evaluate(VioLuaSnapshot);
+  } catch(faudes::Exception& fex) {
+    FD_WARN("VioLuaWorker::Open(): " << fex.What());
+  }
+}
+
+// restore globals (worker thread)
+int VioLuaWorker::Restore(void) {
+  try {
+    mpL->Evaluate("__viorestore()");
+  } catch(faudes::Exception& fex) {
+    FD_DQ("VioLuaWorker::Restore(): " << fex.What());
+    return 1;
+  }
+  return 0;
+}
+
+// run (this is the thread itself, called by start()
+void VioLuaWorker::run(void) {
+  // pay the set-up once
+  Open();
+  // process jobs until shutdown
+  while(VioLuaJob* job = pPool->Take(this)) {
+    // faudes loops of this thread break on the jobs request only
+    VioStyle::FaudesBreakContext(&job->mContext);
+    if(mGlobal) pPool->GlobalMutex()->lock();
+    try {
+      job->Run(mpL);
+    } catch(faudes::Exception& fex) {
+      FD_WARN("VioLuaWorker::run(): uncaught exception: " << fex.What());
+    }
+    if(mGlobal) pPool->GlobalMutex()->unlock();
+    VioStyle::FaudesBreakContext(0);
+    pPool->Finish(job);
+    // reset my state, or rebuild on failure
+    if(!mGlobal) if(Restore()!=0) Open();
+  }
+  // done
+  if(!mGlobal) delete mpL;
+  mpL=0;
+}
+
+
+/*
+ ************************************************
+ ************************************************
+
+ implementation of VioLuaPool
+
+ ************************************************
+ ************************************************
+ */
+
+// static: singleton
+VioLuaPool* VioLuaPool::mpVInstance=0;
+
+// construct
+VioLuaPool::VioLuaPool(QObject* parent) :
+  QObject(parent),
+  mpGlobal(0),
+  mIdle(0),
+  mShutdown(false)
+{
+  mMaxWorkers=qMax(1,QThread::idealThreadCount());
+  if(QCoreApplication::instance())
+    connect(QCoreApplication::instance(),SIGNAL(aboutToQuit()),this,SLOT(Shutdown()));
+}
+
+// destruct
+VioLuaPool::~VioLuaPool(void) {
+  Shutdown();
+}
+
+// access singleton
+VioLuaPool* VioLuaPool::G(void) {
+  if(!mpVInstance) mpVInstance = new VioLuaPool();
+  return mpVInstance;
+}
+
+// destruct singleton
+void VioLuaPool::Destruct(void) {
+  if(!mpVInstance) return;
+  delete mpVInstance;
+  mpVInstance=0;
+}
+
+// start global worker
+void VioLuaPool::Warmup(void) {
+  if(mShutdown) return;
+  if(mpGlobal) return;
+  FD_DQ("VioLuaPool::Warmup()");
+  mpGlobal = new VioLuaWorker(this,true);
+  mWorkers.append(mpGlobal);
+  mpGlobal->start();
+}
+
+// start one more worker
+void VioLuaPool::DoStartWorker(void) {
+  FD_DQ("VioLuaPool::DoStartWorker(): workers #" << mWorkers.size()+1);
+  VioLuaWorker* worker = new VioLuaWorker(this);
+  mWorkers.append(worker);
+  worker->start();
+}
+
+// number of workers
+int VioLuaPool::Workers(void) const {
+  return mWorkers.size();
+}
+
+// queue job
+void VioLuaPool::Submit(VioLuaJob* job) {
+  // report immediately when shut down
+  if(mShutdown) {
+    QMetaObject::invokeMethod(job,"finished",Qt::QueuedConnection);
+    return;
+  }
+  // global worker on first use
+  if(job->Global()) Warmup();
+  // queue
+  QMutexLocker lock(&mMutex);
+  if(job->mPending) return;
+  job->mPending=true;
+  job->mContext.Reset();
+  if(job->Global()) {
+    mGlobalQueue.enqueue(job);
+    mGlobalQueued.wakeOne();
+    return;
+  }
+  mQueue.enqueue(job);
+  // all busy: start another worker (global worker not counted)
+  int workers=mWorkers.size() - (mpGlobal ? 1 : 0);
+  if(mQueue.size()>mIdle && workers<mMaxWorkers) DoStartWorker();
+  mQueued.wakeOne();
+}
+
+// take from queue or wait
+void VioLuaPool::Withdraw(VioLuaJob* job) {
+  QMutexLocker lock(&mMutex);
+  if(mQueue.removeAll(job)+mGlobalQueue.removeAll(job)>0) {
+    job->mPending=false;
+    return;
+  }
+  while(job->mPending)
+    mFinished.wait(&mMutex);
+}
+
+// take from queue if not yet running
+int VioLuaPool::Dequeue(VioLuaJob* job) {
+  QMutexLocker lock(&mMutex);
+  if(mQueue.removeAll(job)+mGlobalQueue.removeAll(job)==0) return 1;
+  job->mPending=false;
+  return 0;
+}
+
+// query job
+bool VioLuaPool::Pending(const VioLuaJob* job) const {
+  QMutexLocker lock(&mMutex);
+  return job->mPending;
+}
+
+// worker: wait for next job (the global worker serves the global queue only)
+VioLuaJob* VioLuaPool::Take(VioLuaWorker* worker) {
+  QMutexLocker lock(&mMutex);
+  VioLuaJob* job=0;
+  if(worker->Global()) {
+    while(mGlobalQueue.isEmpty() && !mShutdown)
+      mGlobalQueued.wait(&mMutex);
+    if(mShutdown) return 0;
+    job = mGlobalQueue.dequeue();
+  } else {
+    mIdle++;
+    while(mQueue.isEmpty() && !mShutdown)
+      mQueued.wait(&mMutex);
+    mIdle--;
+    if(mShutdown) return 0;
+    job = mQueue.dequeue();
+  }
+  mRunning.append(job);
+  return job;
+}
+
+// worker: job done
+void VioLuaPool::Finish(VioLuaJob* job) {
+  // the owner cannot delete the job before we release it
+  emit job->finished();
+  QMutexLocker lock(&mMutex);
+  mRunning.removeAll(job);
+  job->mPending=false;
+  mFinished.wakeAll();
+}
+
+// registry: queued and running jobs
+QList<VioLuaJob*> VioLuaPool::Jobs(void) const {
+  QMutexLocker lock(&mMutex);
+  return mRunning + mGlobalQueue + mQueue;
+}
+
+// registry: number of running jobs
+int VioLuaPool::Running(void) const {
+  QMutexLocker lock(&mMutex);
+  return mRunning.size();
+}
+
+// request break for all jobs
+void VioLuaPool::CancelAll(void) {
+  QMutexLocker lock(&mMutex);
+  FD_DQ("VioLuaPool::CancelAll(): running #" << mRunning.size());
+  foreach(VioLuaJob* job, mRunning)
+    job->mContext.Cancel();
+  foreach(VioLuaJob* job, mGlobalQueue)
+    job->mContext.Cancel();
+  foreach(VioLuaJob* job, mQueue)
+    job->mContext.Cancel();
+}
+
+// stop all workers
+void VioLuaPool::Shutdown(void) {
+  if(mShutdown) return;
+  FD_DQ("VioLuaPool::Shutdown()");
+  // drop queued jobs and wake up workers
+  mMutex.lock();
+  mShutdown=true;
+  foreach(VioLuaJob* job, mGlobalQueue)
+    job->mPending=false;
+  foreach(VioLuaJob* job, mQueue)
+    job->mPending=false;
+  mGlobalQueue.clear();
+  mQueue.clear();
+  mQueued.wakeAll();
+  mGlobalQueued.wakeAll();
+  mFinished.wakeAll();
+  mMutex.unlock();
+  // break running jobs and wait
+  CancelAll();
+  foreach(VioLuaWorker* worker, mWorkers)
+    worker->wait();
+}
@@ -11,6 +11,8 @@
 
 #include "vionameset.h"
 #include "lionameset.h"
+#include <algorithm>
+#include <iterator>
 
 /*
 ****************************************************************
@@ -71,9 +73,9 @@ void VioNameSetData::DoWriteCore(faudes::TokenWriter& rTw, const QString& ftype)
   if(!nset) return;
   // elements from list
   for(int i=0; i<mList.size(); i++) {
-    std::string elem=VioStyle::StrFromQStr(mList.at(i));
-    if(!nset->Exists(elem)) continue;
-    faudes::Idx eidx=nset->Index(elem);
+    faudes::Idx eidx=mList.at(i);
+    if(!nset->Exists(eidx)) continue;
+    std::string elem=nset->SymbolicName(eidx);
     const faudes::AttributeVoid& attr = nset->Attribute(eidx);
     if(attr.IsDefault()) {
       faudes::Token etag;
@@ -151,7 +153,7 @@ void VioNameSetData::DoReadCore(faudes::TokenReader& rTr, const QString& section
     }
     // insert element
     faudes::Idx eidx= nset->Insert(elem);
-    mList.append(VioStyle::QStrFromStr(elem));
+    mList.append(eidx);
     // attribute: 
     faudes::AttributeVoid* attrp = nset->AttributeType()->New();
     attrp->Read(rTr);
@@ -164,6 +166,10 @@ void VioNameSetData::DoReadCore(faudes::TokenReader& rTr, const QString& section
 
 
 
+// binary mime format
+static const char* VioNameSetMimeType="application/x-faudes-vionameset";
+QString VioNameSetData::MimeType(void) { return VioNameSetMimeType; }
+
 // conversion 
 QMimeData* VioNameSetData::ToMime(void) {
   FD_DQN("VioNameSetData::ToMime()");
@@ -174,6 +180,27 @@ QMimeData* VioNameSetData::ToMime(void) {
   // return as mime text
   QMimeData* mdat= new QMimeData();
   mdat->setText(rTw.Str().c_str());
+  // binary format: symbol table block, order, non-default attributes
+  faudes::NameSet* nset=dynamic_cast<faudes::NameSet*>(mFaudesObject);
+  if(nset) {
+    QByteArray buff;
+    QDataStream out(&buff,QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_4_4);
+    QList<faudes::Idx> attridx;
+    out << (qint32) nset->Size();
+    faudes::NameSet::Iterator nit=nset->Begin();
+    for(;nit!=nset->End();nit++) {
+      out << (quint32) *nit << VioStyle::QStrFromStr(nset->SymbolicName(*nit));
+      if(!nset->Attribute(*nit).IsDefault()) attridx.append(*nit);
+    }
+    out << (qint32) mList.size();
+    foreach(faudes::Idx idx, mList) 
+      out << (quint32) idx;
+    out << (qint32) attridx.size();
+    foreach(faudes::Idx idx, attridx) 
+      out << (quint32) idx << VioStyle::QStrFromStr(nset->Attribute(idx).ToString());
+    mdat->setData(VioNameSetMimeType,buff);
+  }
   FD_DQN("VioNameSetData::ToMime(): done");
   return mdat;
 }
@@ -183,6 +210,48 @@ int VioNameSetData::FromMime(const QMimeData* pMime) {
   FD_DQN("VioNameSetData::FromMimeData()");
   Clear();
   int res=0;
+  // try binary format
+  faudes::NameSet* nset=dynamic_cast<faudes::NameSet*>(mFaudesObject);
+  QByteArray buff;
+  if(nset && pMime->hasFormat(VioNameSetMimeType)) buff=pMime->data(VioNameSetMimeType);
+  if(!buff.isEmpty()) {
+    QDataStream in(&buff,QIODevice::ReadOnly);
+    in.setVersion(QDataStream::Qt_4_4);
+    try {
+      // symbol table block: map source indices to ours
+      QHash<quint32,faudes::Idx> idxmap;
+      qint32 n;
+      quint32 sidx;
+      QString str;
+      in >> n;
+      for(int i=0; i<n; i++) {
+        in >> sidx >> str;
+        idxmap[sidx]=nset->Insert(VioStyle::StrFromQStr(str));
+      }
+      // order
+      in >> n;
+      mList.reserve(n);
+      for(int i=0; i<n; i++) {
+        in >> sidx;
+        if(idxmap.contains(sidx)) mList.append(idxmap.value(sidx));
+      }
+      // attributes
+      in >> n;
+      faudes::AttributeVoid* attrp = nset->AttributeType()->New();
+      for(int i=0; i<n; i++) {
+        in >> sidx >> str;
+        if(!idxmap.contains(sidx)) continue;
+        attrp->FromString(VioStyle::StrFromQStr(str));
+        nset->Attribute(idxmap.value(sidx),*attrp);
+      }
+      delete attrp;
+      if(in.status()!=QDataStream::Ok) res=1;
+    } catch(faudes::Exception& exception) {
+      res=1;
+    }
+    if(res!=0) Clear();
+    return res;
+  }
   // convert to std string (can we avoid the copy somehow??)
   std::string tstr=pMime->text().toAscii().constData();
   // convert to token stream
@@ -219,16 +288,88 @@ int VioNameSetData::TestMime(const QMimeData* pMime) {
  */
 
 
-class VioStringOrder {
+class VioSortKey : public QPair<QString,faudes::Idx> {
 public:
-  static bool mLessThan(const QString& elem1, const QString& elem2) {
-    return VioStyle::SortName(elem1) < VioStyle::SortName(elem2);}
-  static bool mGreaterThan(const QString& elem1, const QString& elem2) {
-    return VioStyle::SortName(elem1) > VioStyle::SortName(elem2);}
+  VioSortKey(void) {};
+  VioSortKey(const QString& key, faudes::Idx idx) : QPair<QString,faudes::Idx>(key,idx) {};
+  static bool mLessThan(const VioSortKey& elem1, const VioSortKey& elem2) {
+    return elem1.first < elem2.first;}
+  static bool mGreaterThan(const VioSortKey& elem1, const VioSortKey& elem2) {
+    return elem1.first > elem2.first;}
 };
 
 
 
+/*
+****************************************************************
+****************************************************************
+****************************************************************
+
+Implementation: VioNameSetOperation
+
+****************************************************************
+****************************************************************
+****************************************************************
+*/
+
+// construct
+VioNameSetOperation::VioNameSetOperation(QObject* parent, Operator op) :
+  QThread(parent),
+  mOperator(op),
+  mMask(0),
+  mValue(0),
+  mOperand(0),
+  mRevision(-1)
+{
+}
+
+// destruct (callers thread)
+VioNameSetOperation::~VioNameSetOperation(void) {
+  wait();
+  if(mOperand) delete mOperand;
+}
+
+// run (this is the thread itself, called by start()
+void VioNameSetOperation::run(void) {
+  FD_DQN("VioNameSetOperation::run(): op " << mOperator << " #" << mArgA.size() << " #" << mArgB.size());
+  mResult.clear();
+  mRemoved.clear();
+  mAdded.clear();
+  mMissing.clear();
+  mResult.reserve(mArgA.size()+mArgB.size());
+  std::back_insert_iterator< QVector<faudes::Idx> > out(mResult);
+  switch(mOperator) {
+  case Union:
+    std::set_union(mArgA.begin(),mArgA.end(),mArgB.begin(),mArgB.end(),out);
+    break;
+  case Intersection:
+    std::set_intersection(mArgA.begin(),mArgA.end(),mArgB.begin(),mArgB.end(),out);
+    break;
+  case Difference:
+    std::set_difference(mArgA.begin(),mArgA.end(),mArgB.begin(),mArgB.end(),out);
+    break;
+  case FilterRegExp:
+    for(int i=0; i<mArgA.size(); i++) {
+      QHash<faudes::Idx,QString>::const_iterator nit=mNames.constFind(mArgA.at(i));
+      if(nit==mNames.constEnd()) { mMissing.append(mArgA.at(i)); continue; }
+      if(mRegExp.indexIn(nit.value())>=0) mResult.append(mArgA.at(i));
+    }
+    break;
+  case FilterFlags:
+    for(int i=0; i<mArgA.size() && i<mFlagsA.size(); i++) 
+      if((mFlagsA.at(i) & mMask) == mValue) mResult.append(mArgA.at(i));
+    break;
+  }
+  // changes
+  std::back_insert_iterator< QVector<faudes::Idx> > rem(mRemoved);
+  std::set_difference(mArgA.begin(),mArgA.end(),mResult.begin(),mResult.end(),rem);
+  std::back_insert_iterator< QVector<faudes::Idx> > add(mAdded);
+  std::set_difference(mResult.begin(),mResult.end(),mArgA.begin(),mArgA.end(),add);
+  FD_DQN("VioNameSetOperation::run(): done #" << mResult.size());
+}
+
+
+
 /*
 ****************************************************************
 ****************************************************************
@@ -244,7 +385,7 @@ Implementation: VioNameSetModel
 
 // debugging assistant ... haha 
 #define DUMP  for(int i=0; i< mList.size(); i++) { \
-  FD_DQN("VioNameSetModel::DUMP(): " << VioStyle::StrFromQStr(mList.at(i)));
+  FD_DQN("VioNameSetModel::DUMP(): " << mList.at(i));
 
 
 // construct
@@ -252,7 +393,9 @@ VioNameSetModel::VioNameSetModel(QObject* parent, VioStyle* config, bool alloc)
   VioModel(parent, config, false),
   mpFaudesNameSet(0),
   pNameSetStyle(0),
-  mUserLayout(0)
+  mRowMapFixed(0),
+  mUserLayout(0),
+  mpOperation(0)
 {
   FD_DQN("VioNameSetModel::VioNameSetModel(): " << VioStyle::StrFromQStr(mFaudesType));
   // have typed style
@@ -340,6 +483,8 @@ void VioNameSetModel::DoVioAllocate(void) {
   // dont have anything to allocat, just clear my list
   mpNameSetData->mList.clear();
   mRowMap.clear();
+  mRowMapFixed=0;
+  mNameCache.clear();
   // and have a layout
   mUserLayout = new VioNameSetLayout(this);
   if(pNameSetStyle->mLayoutFlags & VioNameSetStyle::Decorate)
@@ -369,8 +514,8 @@ void VioNameSetModel::DoFaudesUpdate(void) {
   FD_DQN("VioNameSetModel::DoFaudesUpdate()");
   // apply to faudes
   mpFaudesNameSet->Clear();
-  foreach(const QString& name,mpNameSetData->mList) {
-    mpFaudesNameSet->Insert(VioStyle::StrFromQStr(name));
+  foreach(faudes::Idx idx,mpNameSetData->mList) {
+    mpFaudesNameSet->Insert(idx);
   }
   mpFaudesNameSet->Name("NameSet");
 #ifdef FAUDES_DEBUG_VIO_WIDGETS
@@ -389,7 +534,7 @@ void VioNameSetModel::DoVioWrite(faudes::TokenWriter& rTw) const {
   // stream my list
   out << (qint32) mpNameSetData->mList.size();
   for(int i=0; i< mpNameSetData->mList.size(); i++) {
-    out << mpNameSetData->mList.at(i);
+    out << SymbolicName(mpNameSetData->mList.at(i));
   }
   // token io
   rTw.WriteBegin("VioData");
@@ -417,7 +562,9 @@ void VioNameSetModel::DoVioRead(faudes::TokenReader& rTr) {
   in >> len;
   for(int i=0; i<len; i++) {
     in >> name;
-    mpNameSetData->mList.append(name);
+    std::string fname=VioStyle::StrFromQStr(name);
+    if(!mpFaudesNameSet->Exists(fname)) continue;
+    mpNameSetData->mList.append(mpFaudesNameSet->Index(fname));
   }
   // read end token AFTER processing stream
   rTr.ReadEnd("VioData");
@@ -437,8 +584,11 @@ void VioNameSetModel::Layout(const VioNameSetLayout& layout) { *mUserLayout=layo
  
 // edit: clear all
 void VioNameSetModel::Clear(void) {
+  AboutToChange();
   mpNameSetData->mList.clear();
   mRowMap.clear();
+  mRowMapFixed=0;
+  mNameCache.clear();
   mpFaudesNameSet->Clear();
   emit VioModel::NotifyAnyChange();
 }
@@ -460,30 +610,35 @@ VioElement VioNameSetModel::Element(const QString& name) const {
 }
 
 
-// edit: symbol by name
+// edit: symbol by index (via display name cache)
 QString VioNameSetModel::SymbolicName(faudes::Idx idx) const {
-  return VioStyle::QStrFromStr(mpFaudesNameSet->SymbolicName(idx));
+  QHash<faudes::Idx,QString>::const_iterator cit=mNameCache.constFind(idx);
+  if(cit!=mNameCache.constEnd()) return cit.value();
+  QString name=VioStyle::QStrFromStr(mpFaudesNameSet->SymbolicName(idx));
+  if(mpFaudesNameSet->Exists(idx)) mNameCache.insert(idx,name);
+  return name;
 };
 
 // edit: get by position
-const QString& VioNameSetModel::At(int pos) const {
-  static QString empty;
-  if(pos<0 || pos >= mpNameSetData->mList.size()) return empty;
-  return mpNameSetData->mList.at(pos);
+QString VioNameSetModel::At(int pos) const {
+  if(pos<0 || pos >= mpNameSetData->mList.size()) return QString();
+  return SymbolicName(mpNameSetData->mList.at(pos));
 }
 
 // edit: set by position
 bool VioNameSetModel::At(int pos, const QString& name) {
-  if(mRowMap.contains(name)) return false;
+  if(Exists(name)) return false;
   if(pos<0 || pos >= mpNameSetData->mList.size()) return false;
-  const QString& old=mpNameSetData->mList.at(pos);
-  VioElement oelem=Element(old);
+  AboutToChange();
+  faudes::Idx oidx=mpNameSetData->mList.at(pos);
+  VioElement oelem=VioElement::FromEvent(oidx);
   bool sel = IsSelected(oelem);
-  mRowMap.remove(old);
-  mpFaudesNameSet->Erase(VioStyle::StrFromQStr(old));
-  mpNameSetData->mList[pos]=name;
-  mRowMap[name]=pos;
-  mpFaudesNameSet->Insert(VioStyle::StrFromQStr(name));
+  mRowMap.remove(oidx);
+  mNameCache.remove(oidx);
+  mpFaudesNameSet->Erase(oidx);
+  faudes::Idx nidx=mpFaudesNameSet->Insert(VioStyle::StrFromQStr(name));
+  mpNameSetData->mList[pos]=nidx;
+  mRowMap[nidx]=pos;
   Modified(true);
   if(sel) Select(oelem,false);
   emit NotifySymbolChange(name);
@@ -504,16 +659,16 @@ bool VioNameSetModel::Append(const QString& name) {
 
 // edit: insert
 bool VioNameSetModel::Insert(int pos, const QString& name) {
-  if(mRowMap.contains(name)) return false;
+  if(Exists(name)) return false;
   if(pos<0) return false;
   if(pos > mpNameSetData->mList.size()) return false;
-  QMap<QString,int>::iterator lit;
-  for(lit=mRowMap.begin(); lit!=mRowMap.end();lit++) {
-    if(lit.value()>=pos) lit.value()++;
-  }
-  mpNameSetData->mList.insert(pos,name);
-  mRowMap[name]=pos;
-  mpFaudesNameSet->Insert(VioStyle::StrFromQStr(name));
+  AboutToChange();
+  faudes::Idx idx=mpFaudesNameSet->Insert(VioStyle::StrFromQStr(name));
+  mpNameSetData->mList.insert(pos,idx);
+  mRowMap[idx]=pos;
+  // rows after pos are stale (unless we append to a valid map)
+  if(mRowMapFixed==pos && pos==mpNameSetData->mList.size()-1) mRowMapFixed++;
+  else if(mRowMapFixed>pos) mRowMapFixed=pos;
   Modified(true);
   emit NotifySymbolChange(name);
   return true;
@@ -528,50 +683,324 @@ bool VioNameSetModel::Remove(const QString& name) {
 // edit: remove
 bool  VioNameSetModel::RemoveAt(int pos) {
   if(pos<0 || pos >= mpNameSetData->mList.size()) return false;
-  const QString& name=mpNameSetData->mList.at(pos);
-  VioElement elem=Element(name);
+  AboutToChange();
+  faudes::Idx idx=mpNameSetData->mList.at(pos);
+  QString name=SymbolicName(idx);
+  VioElement elem=VioElement::FromEvent(idx);
   bool sel = IsSelected(elem);
-  mRowMap.remove(name);
-  QMap<QString,int>::iterator lit;
-  for(lit=mRowMap.begin(); lit!=mRowMap.end();lit++) {
-    if(lit.value()>=pos) lit.value()--;
-  }
-  mpNameSetData->mList.removeAt(pos);
-  mpFaudesNameSet->Erase(VioStyle::StrFromQStr(name));
+  mRowMap.remove(idx);
+  mNameCache.remove(idx);
+  if(mRowMapFixed>pos) mRowMapFixed=pos;
+  mpFaudesNameSet->Erase(idx);
+  mpNameSetData->mList.remove(pos);
   Modified(true);
   if(sel) Select(elem,false);
   emit NotifySymbolChange(name);
   return true;
 }
 
+// edit: bulk insert (skip existing, one notification)
+bool VioNameSetModel::InsertList(int pos, const QStringList& names) {
+  FD_DQN("VioNameSetModel::InsertList(" << pos << ", #" << names.size() << ")");
+  if(pos<0) return false;
+  if(pos > mpNameSetData->mList.size()) return false;
+  AboutToChange();
+  // collect new names
+  QVector<faudes::Idx> ins;
+  foreach(const QString& name, names) {
+    std::string fname=VioStyle::StrFromQStr(name);
+    if(mpFaudesNameSet->Exists(fname)) continue;
+    faudes::Idx idx=mpFaudesNameSet->Insert(fname);
+    mRowMap.insert(idx,pos+ins.size());
+    mNameCache.insert(idx,name);
+    ins.append(idx);
+  }
+  if(ins.isEmpty()) return false;
+  // splice list in one pass
+  QVector<faudes::Idx>& list=mpNameSetData->mList;
+  if(pos==list.size()) {
+    if(mRowMapFixed==pos) mRowMapFixed+=ins.size();
+    list+=ins;
+  } else {
+    list = list.mid(0,pos) + ins + list.mid(pos);
+    if(mRowMapFixed>pos) mRowMapFixed=pos;
+  }
+  Modified(true);
+  emit NotifyChange();
+  return true;
+}
+
+// edit: bulk remove (skip non-existing, one notification)
+bool VioNameSetModel::RemoveList(const QStringList& names) {
+  FD_DQN("VioNameSetModel::RemoveList(#" << names.size() << ")");
+  // collect existing indices
+  QSet<faudes::Idx> rem;
+  foreach(const QString& name, names) {
+    faudes::Idx idx=Index(name);
+    if(!mRowMap.contains(idx)) continue;
+    rem.insert(idx);
+  }
+  if(rem.isEmpty()) return false;
+  AboutToChange();
+  if(!DoRemoveSet(rem)) return false;
+  Modified(true);
+  emit NotifyChange();
+  return true;
+}
+
+// edit: bulk remove by position
+bool VioNameSetModel::RemoveRange(int pos, int count) {
+  if(pos<0 || count<=0) return false;
+  QStringList names;
+  for(int i=pos; i<pos+count && i<mpNameSetData->mList.size(); i++) 
+    names.append(At(i));
+  return RemoveList(names);
+}
+
 // edit move
 bool VioNameSetModel::Move(int from, int to) {
   if(from<0 || from >= mpNameSetData->mList.size()) return false;
   if(to<0 || to >= mpNameSetData->mList.size()) return false;
-  mpNameSetData->mList.move(from,to);
-  for(int i=from; i<to; i++) 
+  AboutToChange();
+  faudes::Idx idx=mpNameSetData->mList.at(from);
+  mpNameSetData->mList.remove(from);
+  mpNameSetData->mList.insert(to,idx);
+  for(int i=from; i<=to; i++) 
     mRowMap[mpNameSetData->mList.at(i)]=i;
-  for(int i=to; i<from; i++) 
+  for(int i=to; i<=from; i++) 
     mRowMap[mpNameSetData->mList.at(i)]=i;
   Modified(true);
   emit NotifyChange();
   return true;
 }
 
+// edit: bulk assign (retained symbols keep their position, new ones are appended)
+bool VioNameSetModel::AssignSet(const faudes::NameSet& rSet) {
+  FD_DQN("VioNameSetModel::AssignSet(#" << rSet.Size() << ")");
+  UndoEditStart();
+  QSet<faudes::Idx> rem;
+  foreach(faudes::Idx idx, mpNameSetData->mList) 
+    if(!DoContains(rSet,idx)) rem.insert(idx);
+  bool changed=DoRemoveSet(rem);
+  if(DoMergeSet(rSet,true)) changed=true;
+  if(!changed) {
+    UndoEditCancel();
+    return false;
+  }
+  Modified(true);
+  emit NotifyChange();
+  UndoEditStop();
+  return true;
+}
+
+// edit: bulk merge (new symbols are appended, existing ones keep their attribute)
+bool VioNameSetModel::MergeSet(const faudes::NameSet& rSet) {
+  FD_DQN("VioNameSetModel::MergeSet(#" << rSet.Size() << ")");
+  UndoEditStart();
+  if(!DoMergeSet(rSet,false)) {
+    UndoEditCancel();
+    return false;
+  }
+  Modified(true);
+  emit NotifyChange();
+  UndoEditStop();
+  return true;
+}
+
+// edit: bulk subtract
+bool VioNameSetModel::SubtractSet(const faudes::NameSet& rSet) {
+  FD_DQN("VioNameSetModel::SubtractSet(#" << rSet.Size() << ")");
+  UndoEditStart();
+  QSet<faudes::Idx> rem;
+  foreach(faudes::Idx idx, mpNameSetData->mList) 
+    if(DoContains(rSet,idx)) rem.insert(idx);
+  if(!DoRemoveSet(rem)) {
+    UndoEditCancel();
+    return false;
+  }
+  Modified(true);
+  emit NotifyChange();
+  UndoEditStop();
+  return true;
+}
+
+// set algebra: union, intersection or difference with another set
+int VioNameSetModel::SetOperation(VioNameSetOperation::Operator op, const faudes::NameSet& rSet) {
+  if(mpOperation) return 1;
+  if(op!=VioNameSetOperation::Union && op!=VioNameSetOperation::Intersection && 
+     op!=VioNameSetOperation::Difference) return 1;
+  FD_DQN("VioNameSetModel::SetOperation(" << op << ", #" << rSet.Size() << ")");
+  VioNameSetOperation* sop = new VioNameSetOperation(this,op);
+  // have the other set in my symbol table
+  if(rSet.SymbolTablep()==mpFaudesNameSet->SymbolTablep()) {
+    sop->mOperand=rSet.Copy();
+  } else {
+    sop->mOperand=mpFaudesNameSet->New();
+    sop->mOperand->SymbolTablep(mpFaudesNameSet->SymbolTablep());
+    faudes::NameSet::Iterator sit=rSet.Begin();
+    for(;sit!=rSet.End();sit++) {
+      faudes::Idx idx=sop->mOperand->Insert(rSet.SymbolicName(*sit));
+      try {
+        sop->mOperand->Attribute(idx,rSet.Attribute(*sit));
+      } catch(faudes::Exception& exception) {
+      }
+    }
+  }
+  // faudes sets iterate by index, so this is sorted
+  sop->mArgB.reserve(sop->mOperand->Size());
+  faudes::NameSet::Iterator oit=sop->mOperand->Begin();
+  for(;oit!=sop->mOperand->End();oit++) 
+    sop->mArgB.append(*oit);
+  DoOperationStart(sop);
+  return 0;
+}
+
+// set algebra: filter by regular expression on symbolic names
+int VioNameSetModel::FilterOperation(const QRegExp& rRegExp) {
+  if(mpOperation) return 1;
+  if(!rRegExp.isValid()) return 1;
+  FD_DQN("VioNameSetModel::FilterOperation(" << VioStyle::StrFromQStr(rRegExp.pattern()) << ")");
+  VioNameSetOperation* sop = new VioNameSetOperation(this,VioNameSetOperation::FilterRegExp);
+  sop->mRegExp=rRegExp;
+  DoOperationStart(sop);
+  return 0;
+}
+
+// set algebra: filter by attribute flags 
+int VioNameSetModel::FilterOperation(faudes::fType mask, faudes::fType value) {
+  if(mpOperation) return 1;
+  FD_DQN("VioNameSetModel::FilterOperation(" << mask << ", " << value << ")");
+  VioNameSetOperation* sop = new VioNameSetOperation(this,VioNameSetOperation::FilterFlags);
+  sop->mMask=mask;
+  sop->mValue=value & mask;
+  DoOperationStart(sop);
+  return 0;
+}
+
+// set algebra: block until the pending operation is applied
+void VioNameSetModel::OperationWait(void) {
+  while(mpOperation) {
+    mpOperation->wait();
+    DoOperationDone();
+  }
+}
+
+// set algebra: take snapshot of my elements and start thread
+void VioNameSetModel::DoOperationStart(VioNameSetOperation* op) {
+  op->mArgA.clear();
+  op->mNames.clear();
+  op->mFlagsA.clear();
+  op->mArgA.reserve(mpFaudesNameSet->Size());
+  // names: shallow copy of the cache, the thread reports misses
+  if(op->mOperator==VioNameSetOperation::FilterRegExp) 
+    op->mNames=mNameCache;
+  faudes::NameSet::Iterator nit=mpFaudesNameSet->Begin();
+  for(;nit!=mpFaudesNameSet->End();nit++) {
+    op->mArgA.append(*nit);
+    if(op->mOperator==VioNameSetOperation::FilterFlags) {
+      faudes::fType flags=0;
+      try {
+        const faudes::AttributeFlags* fattr=
+          dynamic_cast<const faudes::AttributeFlags*>(&mpFaudesNameSet->Attribute(*nit));
+        if(fattr) flags=fattr->mFlags;
+      } catch(faudes::Exception& exception) {
+      }
+      op->mFlagsA.append(flags);
+    }
+  }
+  op->mRevision=DataRevision();
+  if(mpOperation!=op) {
+    mpOperation=op;
+    connect(op,SIGNAL(finished()),this,SLOT(DoOperationDone()));
+  }
+  op->start();
+}
+
+// set algebra: thread finished, apply as one edit
+void VioNameSetModel::DoOperationDone(void) {
+  VioNameSetOperation* op=mpOperation;
+  if(!op) return;
+  if(op->isRunning()) return;
+  // i was edited meanwhile: restart with a fresh snapshot
+  if(op->mRevision!=DataRevision() || op->mArgA.size()!=(int) mpFaudesNameSet->Size()) {
+    FD_DQN("VioNameSetModel::DoOperationDone(): restart");
+    DoOperationStart(op);
+    return;
+  }
+  // names were missing: resolve and restart
+  if(!op->mMissing.isEmpty()) {
+    FD_DQN("VioNameSetModel::DoOperationDone(): resolve names #" << op->mMissing.size());
+    foreach(faudes::Idx idx, op->mMissing) 
+      SymbolicName(idx);
+    DoOperationStart(op);
+    return;
+  }
+  mpOperation=0;
+  UndoEditStart();
+  bool changed=DoOperationApply(op);
+  if(changed) {
+    Modified(true);
+    emit NotifyChange();
+    UndoEditStop();
+  } else {
+    UndoEditCancel();
+  }
+  op->deleteLater();
+  FD_DQN("VioNameSetModel::DoOperationDone(): changed " << changed);
+  emit NotifyOperationDone(changed);
+}
+
+// set algebra: apply changes (retained symbols keep their position, new ones are appended)
+bool VioNameSetModel::DoOperationApply(const VioNameSetOperation* op) {
+  bool changed=false;
+  if(!op->mRemoved.isEmpty()) {
+    QSet<faudes::Idx> rem;
+    rem.reserve(op->mRemoved.size());
+    foreach(faudes::Idx idx, op->mRemoved) 
+      rem.insert(idx);
+    changed=DoRemoveSet(rem);
+  }
+  // new symbols can only come from the other set
+  if(!op->mOperand) return changed;
+  if(op->mAdded.isEmpty()) return changed;
+  QVector<faudes::Idx>& list=mpNameSetData->mList;
+  int osize=list.size();
+  foreach(faudes::Idx idx, op->mAdded) {
+    if(mpFaudesNameSet->Exists(idx)) continue;
+    if(!op->mOperand->Exists(idx)) continue;
+    mpFaudesNameSet->Insert(idx);
+    try {
+      mpFaudesNameSet->Attribute(idx,op->mOperand->Attribute(idx));
+    } catch(faudes::Exception& exception) {
+    }
+    mRowMap.insert(idx,list.size());
+    list.append(idx);
+    changed=true;
+  }
+  if(mRowMapFixed==osize) mRowMapFixed=list.size();
+  return changed;
+}
+
 // edit: find
 int VioNameSetModel::IndexOf(const QString& name) const {
-  QMap<QString,int>::const_iterator lit;
-  lit=mRowMap.constFind(name);
-  if(lit==mRowMap.end()) return -1;
-  return lit.value();
+  return IndexOf(Index(name));
+}
+
+// edit: find by faudes index (fix row map on stale entry)
+int VioNameSetModel::IndexOf(faudes::Idx idx) const {
+  QHash<faudes::Idx,int>::const_iterator lit;
+  lit=mRowMap.constFind(idx);
+  if(lit==mRowMap.constEnd()) return -1;
+  int pos=lit.value();
+  if(pos>=0 && pos<mpNameSetData->mList.size()) 
+    if(mpNameSetData->mList.at(pos)==idx) return pos;
+  DoFixRowMap(mRowMapFixed);
+  return mRowMap.value(idx,-1);
 }
   
 // edit: contains
 bool VioNameSetModel::Exists(const QString& name) const {
-  QMap<QString,int>::const_iterator lit;
-  lit=mRowMap.constFind(name);
-  if(lit==mRowMap.end()) return false;
-  return true;
+  return mpFaudesNameSet->Exists(VioStyle::StrFromQStr(name));
 }
 
 // edit: new symbol 
@@ -586,8 +1015,7 @@ QString VioNameSetModel::UniqueSymbol(const QString& name) {
 // sorting
 void VioNameSetModel::SortAscending(void) {
   FD_DQN("VioNameSetModel::SortAscendingEv()");
-  qStableSort(mpNameSetData->mList.begin(), mpNameSetData->mList.end(), VioStringOrder::mLessThan);
-  DoFixRowMap();
+  DoSort(false);
   emit NotifyChange();
   FD_DQN("VioNameSetModel::SortAscendingEv(): done");
 }
@@ -595,12 +1023,25 @@ void VioNameSetModel::SortAscending(void) {
 // sorting
 void VioNameSetModel::SortDescending(void) {
   FD_DQN("VioNameSetModel::SortDescending()");
-  qStableSort(mpNameSetData->mList.begin(), mpNameSetData->mList.end(), VioStringOrder::mGreaterThan);
-  DoFixRowMap();
+  DoSort(true);
   emit NotifyChange();
   FD_DQN("VioNameSetModel::SortDescending(): done");
 }
 
+// sorting: have keys once, sort and write back
+void VioNameSetModel::DoSort(bool descending) {
+  AboutToChange();
+  QVector<VioSortKey> keys;
+  keys.reserve(mpNameSetData->mList.size());
+  foreach(faudes::Idx idx, mpNameSetData->mList) 
+    keys.append(VioSortKey(VioStyle::SortName(SymbolicName(idx)),idx));
+  if(!descending) qStableSort(keys.begin(), keys.end(), VioSortKey::mLessThan);
+  else qStableSort(keys.begin(), keys.end(), VioSortKey::mGreaterThan);
+  for(int i=0; i<keys.size(); i++) 
+    mpNameSetData->mList[i]=keys.at(i).second;
+  DoFixRowMap();
+}
+
 
 // edit: set attribute 
 bool VioNameSetModel::Attribute(const QString& name, const faudes::AttributeVoid& attr) {
@@ -609,6 +1050,7 @@ bool VioNameSetModel::Attribute(const QString& name, const faudes::AttributeVoid
   if(!Exists(name)) return false;
   // bail on on identical
   if(Attribute(name).Equal(attr)) return false;  
+  AboutToChange();
   // figure and set attribute
   try {
     faudes::Idx idx=mpFaudesNameSet->Index(VioStyle::StrFromQStr(name));
@@ -682,34 +1124,113 @@ void VioNameSetModel::BooleanProperty(const QString& name, int prop, bool val) {
 }
 
 
-// fix internal data
-void  VioNameSetModel::DoFixRowMap(void) {
-  mRowMap.clear();
-  for(int count=0; count < mpNameSetData->mList.size(); count++)
-    mRowMap[mpNameSetData->mList[count]]=count; 
+// bulk edit helper: test membership by index or, for foreign symbol tables, by name
+bool VioNameSetModel::DoContains(const faudes::NameSet& rSet, faudes::Idx idx) const {
+  if(rSet.SymbolTablep()==mpFaudesNameSet->SymbolTablep()) return rSet.Exists(idx);
+  return rSet.Exists(mpFaudesNameSet->SymbolicName(idx));
+}
+
+// bulk edit helper: filter list in one pass, unselect removed symbols
+bool VioNameSetModel::DoRemoveSet(const QSet<faudes::Idx>& rRemove) {
+  if(rRemove.isEmpty()) return false;
+  QVector<faudes::Idx>& list=mpNameSetData->mList;
+  QVector<faudes::Idx> keep;
+  keep.reserve(list.size());
+  int first=-1;
+  for(int i=0; i<list.size(); i++) {
+    faudes::Idx idx=list.at(i);
+    if(!rRemove.contains(idx)) { keep.append(idx); continue; }
+    if(first<0) first=i;
+    VioElement elem=VioElement::FromEvent(idx);
+    if(IsSelected(elem)) Select(elem,false);
+    mRowMap.remove(idx);
+    mNameCache.remove(idx);
+    mpFaudesNameSet->Erase(idx);
+  }
+  if(first<0) return false;
+  list=keep;
+  if(mRowMapFixed>first) mRowMapFixed=first;
+  return true;
+}
+
+// bulk edit helper: append new symbols in one pass (optionally overwrite attributes)
+bool VioNameSetModel::DoMergeSet(const faudes::NameSet& rSet, bool attr) {
+  bool sametab = rSet.SymbolTablep()==mpFaudesNameSet->SymbolTablep();
+  bool changed=false;
+  QVector<faudes::Idx>& list=mpNameSetData->mList;
+  int osize=list.size();
+  list.reserve(osize+rSet.Size());
+  faudes::NameSet::Iterator sit=rSet.Begin();
+  faudes::NameSet::Iterator sit_end=rSet.End();
+  for(;sit!=sit_end;sit++) {
+    // figure my index
+    faudes::Idx idx=*sit;
+    bool isnew;
+    if(sametab) {
+      isnew=!mpFaudesNameSet->Exists(idx);
+      if(isnew) mpFaudesNameSet->Insert(idx);
+    } else {
+      std::string name=rSet.SymbolicName(*sit);
+      isnew=!mpFaudesNameSet->Exists(name);
+      idx = isnew ? mpFaudesNameSet->Insert(name) : mpFaudesNameSet->Index(name);
+    }
+    // append to list
+    if(isnew) {
+      mRowMap.insert(idx,list.size());
+      list.append(idx);
+      changed=true;
+    }
+    // attribute (ignore incompatible types)
+    if(!isnew && !attr) continue;
+    try {
+      const faudes::AttributeVoid& sattr=rSet.Attribute(*sit);
+      if(mpFaudesNameSet->Attribute(idx).Equal(sattr)) continue;
+      mpFaudesNameSet->Attribute(idx,sattr);
+      changed=true;
+    } catch(faudes::Exception& exception) {
+    }
+  }
+  if(mRowMapFixed==osize) mRowMapFixed=list.size();
+  return changed;
+}
+
+
+// fix internal data (from=0 for a complete rebuild)
+void  VioNameSetModel::DoFixRowMap(int from) const {
+  if(from<=0) {
+    mRowMap.clear();
+    mRowMap.reserve(mpNameSetData->mList.size());
+    from=0;
+  }
+  for(int count=from; count < mpNameSetData->mList.size(); count++)
+    mRowMap[mpNameSetData->mList.at(count)]=count; 
+  mRowMapFixed=mpNameSetData->mList.size();
 }
 
 
-// fix internal data
+// fix internal data (diff by index against faudes set)
 void  VioNameSetModel::DoFixList(void) {
-  // carefull upate: remove items from my list, that are not in the faudes set
-  bool nf=false;
-  for(int i=0; i<mpNameSetData->mList.size(); i++) {
-    if(mpFaudesNameSet->Exists(VioStyle::StrFromQStr(mpNameSetData->mList.at(i)))) continue;
-    mpNameSetData->mList.removeAt(i);
-    nf=true;
-    i--;
+  QVector<faudes::Idx> list;
+  list.reserve(mpFaudesNameSet->Size());
+  QSet<faudes::Idx> known;
+  known.reserve(mpFaudesNameSet->Size());
+  // carefull upate: keep items from my list, that are in the faudes set
+  foreach(faudes::Idx idx, mpNameSetData->mList) {
+    if(!mpFaudesNameSet->Exists(idx)) continue;
+    if(known.contains(idx)) continue;
+    known.insert(idx);
+    list.append(idx);
   }  
-  if(nf) DoFixRowMap();
   // carefull update: append items, that not in my list
   faudes::NameSet::Iterator nit=mpFaudesNameSet->Begin();
   faudes::NameSet::Iterator nit_end=mpFaudesNameSet->End();
   for(;nit!=nit_end;nit++) {
-    QString name=VioStyle::QStrFromStr(mpFaudesNameSet->SymbolicName(*nit));
-    if(Exists(name)) continue;
-    mRowMap[name]=mpNameSetData->mList.size();
-    mpNameSetData->mList.append(name);
+    if(known.contains(*nit)) continue;
+    list.append(*nit);
   }
+  mpNameSetData->mList=list;
+  mNameCache.clear();
+  DoFixRowMap();
 }
 
 
@@ -789,10 +1310,11 @@ int VioNameSetModel::DoMergeData(const VioData* pData) {
   }
   // insert events to vio list
   for(int i=0; i<ndat->mList.size(); i++) {
-    std::string fname=VioStyle::StrFromQStr(ndat->mList.at(i));
-    if(!nset->Exists(fname)) continue;
-    if(mpNameSetData->mList.contains(ndat->mList.at(i))) continue;
-    mpNameSetData->mList.append(ndat->mList.at(i));
+    faudes::Idx idx=ndat->mList.at(i);
+    if(!nset->Exists(idx)) continue;
+    if(mRowMap.contains(idx)) continue;
+    mRowMap.insert(idx,mpNameSetData->mList.size());
+    mpNameSetData->mList.append(idx);
     changed=true;
   }
   // fix me
@@ -826,7 +1348,7 @@ int VioNameSetModel::Data(const VioData* pData) {
   // reconstruct selection if possible
   mSelection.clear();
   if(Exists(selname)) {  
-    faudes::Idx selidx=IndexOf(selname);
+    faudes::Idx selidx=Index(selname);
     mSelection.append(VioElement::FromEvent(selidx));
   }
   emit NotifySelectionChange();    // universal selection change
@@ -839,6 +1361,7 @@ int VioNameSetModel::Data(const VioData* pData) {
 int VioNameSetModel::InsertData(const VioData* pData) {
   FD_DQN("VioNameSetModel::InsertData(): test types");
   if(TypeCheckData(pData)!=0) return 1;
+  AboutToChange();
   // do the insert (incl selection)
   bool changed=DoMergeData(pData);
   // modified and signals
@@ -856,10 +1379,12 @@ int VioNameSetModel::InsertData(const VioData* pData) {
 // delete selection
 void VioNameSetModel::DeleteSelection(void) {
   FD_DQN("VioNameSetModel::DeleteSelection()");
+  QStringList names;
   foreach(VioElement elem, mSelection) {
     if(!elem.IsEvent()) continue;
-    Remove(VioStyle::QStrFromStr(mpFaudesNameSet->SymbolicName(elem.Event())));
+    names.append(SymbolicName(elem.Event()));
   }
+  RemoveList(names);
   SelectionClear(); // should we keep an selection pint for insertion?
   FD_DQN("VioNameSetModel::DeleteSelection(): done ");
 }
@@ -943,6 +1468,8 @@ VioNameSetView::VioNameSetView(QWidget* parent, VioStyle* config, bool alloc) :
     FD_WARN("VioAttributView::VioNameSetModel(): invalid style, using default.");
     pNameSetStyle= new VioNameSetStyle(mFaudesType);
   }
+  // selection is model based: can defer clipboard copy
+  mLazyCopy=true;
   // my alloc
   if(alloc) DoVioAllocate();
   FD_DQN("VioNameSetView::VioNameSetView(): done");
@@ -1081,6 +1608,11 @@ void VioNameSetView::DeleteSelection(void) {
   if(pNameSetModel) pNameSetModel->DeleteSelection();
 }
 
+// mime formats
+QStringList VioNameSetView::MimeFormats(void) const {
+  return QStringList() << VioNameSetData::MimeType() << "text/plain";
+}
+
 
 // show/hide views from layout
 void VioNameSetView::UpdateUserLayout(void) {
@@ -87,6 +87,10 @@ QString VioStyle::mLicenseText =
 // static: faudes break
 bool VioStyle::mFaudesBreakFlag=false;
 
+// static: faudes break context per thread (storage owns the holder, not the context)
+struct VioCancelHolder { VioCancelContext* pContext; };
+static QThreadStorage<VioCancelHolder*> vioBreakContexts;
+
 
 // static default: geometry of arrow
 qreal VioStyle::mArrowRatio=0.66;
@@ -463,27 +467,40 @@ QString VioStyle::DispEventName(const faudes::EventSet* set, faudes::Idx idx) {
 }
 
 
-// sort string: fix digits: sugar or waste?
+// sort key: natural order by code unit compare
+// - digit runs drop leading zeros and get a length prefix, i.e., 
+//   (L-1)/9 times '9' followed by '0'+(L-1)%9, so numbers of any 
+//   length compare numerically and still sort before letters
+// - a leading '#' sorts last
+// - returns key length; dst must hold 2*len+1 code units
+int VioStyle::SortKey(const ushort* src, int len, ushort* dst){
+  ushort* out=dst;
+  const ushort* end=src+len;
+  while(src<end) {
+    // copy non-digits
+    if(*src<'0' || *src>'9') { *out++ = *src++; continue; }
+    // skip leading zeros (keep one)
+    const ushort* num=src;
+    while(num+1<end && *num=='0' && num[1]>='0' && num[1]<='9') num++;
+    src=num;
+    while(src<end && *src>='0' && *src<='9') src++;
+    // length prefix and digits
+    int l=src-num-1;
+    for(;l>=9;l-=9) *out++ = '9';
+    *out++ = '0'+l;
+    while(num<src) *out++ = *num++;
+  }
+  // fix prefix #
+  if(out>dst && dst[0]=='#') dst[0]=127;
+  return out-dst;
+}
+
+// sort string (see SortKey)
 QString VioStyle::SortName(const QString& str){
   QString res;
-  int src=0, numstart, numstop, miss;
-  // fix autoappendix digits
-  for(src=0; src<str.size(); src++) {
-    const QChar c=str[src];
-    if(!c.isDigit()) 
-      { res.append(c); continue; };
-    numstart=src;
-    while(src<str.size()) 
-      { if(!str[src].isDigit()) break; src++; }
-    numstop=src;
-    miss=5-(numstop-numstart);
-    for(;miss>0;miss--) res.append('0');
-    for(;numstart<numstop; numstart++) res.append(str[numstart]);
-  }
-  // fix prefic #
-  if(res.size()>=1) 
-  if(res[0]=='#') res[0]=127;
-  FD_DQ("VioStyle::SortName("<< str << "): " << res);
+  res.resize(2*str.size()+1);
+  int len=SortKey(str.utf16(),str.size(),reinterpret_cast<ushort*>(res.data()));
+  res.resize(len);
   return res;
 }
 
@@ -603,6 +620,12 @@ bool VioStyle::FaudesBreakFnct(void) {
 #ifdef FAUDES_DEBUG_SCRIPT
   // std::cout << "FaudesBreakFnct(): " << mFaudesBreakFlag << std::endl;
 #endif
+  // context bound to this thread takes precedence
+  if(vioBreakContexts.hasLocalData()) {
+    VioCancelContext* context=vioBreakContexts.localData()->pContext;
+    if(context) return context->Canceled();
+  }
+  // global flag
   if(!mFaudesBreakFlag) return false;
 #ifdef FAUDES_DEBUG_SCRIPT
   std::cout << "FAUDES_STDOUT: FaudesBreakFnct(): " << mFaudesBreakFlag << std::endl;
@@ -618,6 +641,19 @@ void VioStyle::FaudesBreakSet(void) {
 void VioStyle::FaudesBreakClr(void) {
   mFaudesBreakFlag=false;
 }
+// bind context to current thread
+void VioStyle::FaudesBreakContext(VioCancelContext* context) {
+  if(!vioBreakContexts.hasLocalData()) {
+    if(!context) return;
+    vioBreakContexts.setLocalData(new VioCancelHolder());
+  }
+  vioBreakContexts.localData()->pContext=context;
+}
+// get context of current thread
+VioCancelContext* VioStyle::FaudesBreakContext(void) {
+  if(!vioBreakContexts.hasLocalData()) return 0;
+  return vioBreakContexts.localData()->pContext;
+}
 
 /*
  *************************************
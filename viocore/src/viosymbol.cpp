@@ -9,6 +9,7 @@
 
 
 #include "viosymbol.h"
+#include <algorithm>
 
 
 
@@ -73,12 +74,17 @@ VioSymbolValidator::State VioSymbolValidator::validate(QString& input, int & pos
   // validate known faudes symbol 
   if(input=="") return Intermediate;
   if(!faudes::SymbolTable::ValidSymbol(VioStyle::StrFromQStr(input))) return Invalid;
+  // use index of symbol completer (unknown symbols are rejected on commit)
+  if(VioSymbolCompleter* vscompleter=qobject_cast<VioSymbolCompleter*>(pCompleter)) {
+    if(vscompleter->isKnownSymbol(input)) return Acceptable;
+    return Intermediate;
+  }
+  // fallback for other completers
   if(pCompleter) 
     if(QStringListModel* strlist=qobject_cast<QStringListModel*>(pCompleter->model())) {
       if(strlist->stringList().contains(input)) 
         return Acceptable;
     }
-  // todo: use completer to figure intermediate
   return Intermediate;
 };
 
@@ -167,6 +173,13 @@ void VioSymbolEdit::setSymbolMode(VioSymbol::Mode mode) {
   mComboBox->view()->removeEventFilter(this);
   mComboBox->lineEdit()->removeEventFilter(this);
   // initialise edit widget and put to front
+  // search completion runs on user edits
+  if(VioSymbolCompleter* scompleter=qobject_cast<VioSymbolCompleter*>(pCompleter)) {
+    disconnect(mLineEdit,SIGNAL(textEdited(const QString&)),scompleter,SLOT(SearchEdited(const QString&)));
+    disconnect(mComboBox->lineEdit(),SIGNAL(textEdited(const QString&)),scompleter,SLOT(SearchEdited(const QString&)));
+    QLineEdit* edit= (mSymbolMode & VioSymbol::ComboBox) ? mComboBox->lineEdit() : mLineEdit;
+    connect(edit,SIGNAL(textEdited(const QString&)),scompleter,SLOT(SearchEdited(const QString&)));
+  }
   if(!(mSymbolMode & VioSymbol::ComboBox)) {
     if(pCompleter)  mLineEdit->setCompleter(pCompleter);
     mLineEdit->setValidator(mValidator);
@@ -383,7 +396,9 @@ bool VioSymbolEdit::validate(void) {
   bool valid=  (mValidator->validate(line,pos)==QValidator::Acceptable);
   // are we known to the completer?
   bool known=false;
-  if(pCompleter) {
+  if(VioSymbolCompleter* vscompleter=qobject_cast<VioSymbolCompleter*>(pCompleter)) {
+    known=vscompleter->isKnownSymbol(line);
+  } else if(pCompleter) {
     if(QStringListModel* strlist=qobject_cast<QStringListModel*>(pCompleter->model())) {
       if(strlist->stringList().contains(text())) known=true;
     }
@@ -412,19 +427,391 @@ bool VioSymbolEdit::validate(void) {
  ******************************************
  */
 
+// static: registry of shared worlds
+QHash<QString,VioSymbolWorld*>* VioSymbolWorld::msRegistry=0;
+
 // construct
-VioSymbolCompleter::VioSymbolCompleter(QObject *parent) : QCompleter(parent) {
-  mSymbolWorld= new QStringListModel(0);
-  setModel(mSymbolWorld);
+VioSymbolWorld::VioSymbolWorld(QObject* parent) : QObject(parent) {
+  mSymbolWorld= new QStringListModel(this);
+  pSymbolSource=0;
+  mSymbolSourceColumn=0;
+  mSourceSynced=false;
+  mSearchValid=false;
+  mSearchHoles=0;
+  mRefCount=0;
+}
+
+// destruct
+VioSymbolWorld::~VioSymbolWorld(void) {
+  FD_DQ("VioSymbolWorld:::~VioSymbolWorld(): " << VioStyle::StrFromQStr(mKey));
+  if(msRegistry && mKey!="") msRegistry->remove(mKey);
+}
+
+// static: attach to shared world
+VioSymbolWorld* VioSymbolWorld::Acquire(const QString& rKey) {
+  if(!msRegistry) msRegistry = new QHash<QString,VioSymbolWorld*>();
+  VioSymbolWorld* world=msRegistry->value(rKey,0);
+  if(!world) {
+    FD_DQ("VioSymbolWorld::Acquire(): new world " << VioStyle::StrFromQStr(rKey));
+    world = new VioSymbolWorld();
+    world->mKey=rKey;
+    msRegistry->insert(rKey,world);
+  }
+  world->mRefCount++;
+  return world;
+}
+
+// static: detach from shared world
+void VioSymbolWorld::Release(VioSymbolWorld* pWorld) {
+  if(!pWorld) return;
+  if(--pWorld->mRefCount > 0) return;
+  FD_DQ("VioSymbolWorld::Release(): last user of " << VioStyle::StrFromQStr(pWorld->mKey));
+  delete pWorld;
+}
+
+// static: key
+QString VioSymbolWorld::Key(const void* pOwner, const QString& rType) {
+  return QString("%1:%2").arg((quintptr) pOwner,0,16).arg(rType);
+}
+
+// source: list of strings
+void VioSymbolWorld::setSymbols(const QStringList& rStringList) {
+  Clear();
+  SetSymbols(rStringList);
+}
+
+// source: other model
+void VioSymbolWorld::setSource(QAbstractItemModel* pStringModel, int col) {
+  Clear();
+  pSymbolSource=pStringModel;
+  mSymbolSourceColumn=col;
+  if(pSymbolSource) {
+    // track changes incrementally
+    connect(pSymbolSource,SIGNAL(rowsInserted(const QModelIndex&, int, int)),
+      this,SLOT(SourceRowsInserted(const QModelIndex&, int, int)));
+    connect(pSymbolSource,SIGNAL(rowsRemoved(const QModelIndex&, int, int)),
+      this,SLOT(SourceRowsRemoved(const QModelIndex&, int, int)));
+    connect(pSymbolSource,SIGNAL(dataChanged(const QModelIndex&, const QModelIndex&)),
+      this,SLOT(SourceDataChanged(const QModelIndex&, const QModelIndex&)));
+    // fall back to full copy on structural changes
+    connect(pSymbolSource,SIGNAL(modelReset()),this,SLOT(SourceReset()));
+    connect(pSymbolSource,SIGNAL(layoutChanged()),this,SLOT(SourceReset()));
+    connect(pSymbolSource,SIGNAL(rowsMoved(const QModelIndex&, int, int, const QModelIndex&, int)),
+      this,SLOT(SourceReset()));
+    connect(pSymbolSource,SIGNAL(destroyed()),this,SLOT(Clear()));
+  }
+  Update();
+}
+
+// update from source (full copy, unless we are in sync anyway)
+void VioSymbolWorld::Update(void) {
+  if(!pSymbolSource) return;
+  if(mSourceSynced) return;
+  FD_DQ("VioSymbolWorld::Update("<<this << "): from model with #" << pSymbolSource->rowCount()
+	<< " at column " << mSymbolSourceColumn);
+  mSourceSymbols.clear();
+  for(int row=0; row < pSymbolSource->rowCount(); row++) 
+    mSourceSymbols.append(SourceSymbol(row));
+  SetSymbols(mSourceSymbols);
+  mSourceSynced=true;
+  FD_DQ("VioSymbolWorld::Update("<<this << "): results in #" << mSymbolWorld->rowCount());
+}
+
+// release mem
+void VioSymbolWorld::Clear(void) {
+  if(pSymbolSource) disconnect(pSymbolSource,0,this,0);
+  mSymbolWorld->setStringList(QStringList());
+  mSymbolCount.clear();
+  mSourceSymbols.clear();
   pSymbolSource=0;
+  mSourceSynced=false;
+  mSearchValid=false;
+};
+
+// helper: symbol at source row ("" for invalid)
+QString VioSymbolWorld::SourceSymbol(int row) const {
+  QModelIndex source=pSymbolSource->index(row,mSymbolSourceColumn);
+  if(!source.isValid()) return QString();
+  QString symbol= pSymbolSource->data(source).toString();
+  if(!VioStyle::ValidSymbol(symbol)) return QString();
+  return symbol;
+}
+
+// helper: set all symbols (sorted and unique)
+void VioSymbolWorld::SetSymbols(const QStringList& rSymbols) {
+  mSymbolCount.clear();
+  mSymbolCount.reserve(rSymbols.size());
+  foreach(const QString& symbol, rSymbols) 
+    if(!symbol.isEmpty()) mSymbolCount[symbol]++;
+  QStringList world=mSymbolCount.keys();
+  qSort(world);
+  mSymbolWorld->setStringList(world);
+  mSearchValid=false;
+  FD_DQ("VioSymbolWorld::SetSymbols("<<this << "): #" << world.size());
+}
+
+// helper: sorted position of symbol in my world
+int VioSymbolWorld::SymbolPosition(const QString& rSymbol) const {
+  const QStringList world=mSymbolWorld->stringList();
+  return qLowerBound(world.begin(),world.end(),rSymbol) - world.begin();
+}
+
+// helper: insert one symbol
+void VioSymbolWorld::InsertSymbol(const QString& rSymbol) {
+  if(rSymbol.isEmpty()) return;
+  if(mSymbolCount[rSymbol]++ > 0) return;
+  int pos=SymbolPosition(rSymbol);
+  mSymbolWorld->insertRows(pos,1);
+  mSymbolWorld->setData(mSymbolWorld->index(pos),rSymbol);
+  if(mSearchValid) SearchIndexInsert(rSymbol);
+}
+
+// helper: remove one symbol
+void VioSymbolWorld::RemoveSymbol(const QString& rSymbol) {
+  if(rSymbol.isEmpty()) return;
+  QHash<QString,int>::iterator cit=mSymbolCount.find(rSymbol);
+  if(cit==mSymbolCount.end()) return;
+  if(--cit.value() > 0) return;
+  mSymbolCount.erase(cit);
+  int pos=SymbolPosition(rSymbol);
+  mSymbolWorld->removeRows(pos,1);
+  if(mSearchValid) SearchIndexRemove(rSymbol);
+}
+
+// source: rows inserted
+void VioSymbolWorld::SourceRowsInserted(const QModelIndex& parent, int first, int last) {
+  if(parent.isValid() || !mSourceSynced) return;
+  FD_DQ("VioSymbolWorld::SourceRowsInserted("<<this << "): " << first << "-" << last);
+  QStringList symbols;
+  for(int row=first; row<=last; row++) 
+    symbols.append(SourceSymbol(row));
+  for(int i=symbols.size()-1; i>=0; i--) 
+    mSourceSymbols.insert(first,symbols.at(i));
+  // bulk insert: rebuild the world at once
+  if(symbols.size() > 64 && symbols.size() > mSymbolWorld->rowCount()/8) {
+    SetSymbols(mSourceSymbols);
+    return;
+  }
+  foreach(const QString& symbol, symbols) 
+    InsertSymbol(symbol);
+}
+
+// source: rows removed
+void VioSymbolWorld::SourceRowsRemoved(const QModelIndex& parent, int first, int last) {
+  if(parent.isValid() || !mSourceSynced) return;
+  FD_DQ("VioSymbolWorld::SourceRowsRemoved("<<this << "): " << first << "-" << last);
+  if(last>=mSourceSymbols.size()) { SourceReset(); return; }
+  QStringList symbols=mSourceSymbols.mid(first,last-first+1);
+  mSourceSymbols.erase(mSourceSymbols.begin()+first,mSourceSymbols.begin()+last+1);
+  // bulk remove: rebuild the world at once
+  if(symbols.size() > 64 && symbols.size() > mSymbolWorld->rowCount()/8) {
+    SetSymbols(mSourceSymbols);
+    return;
+  }
+  foreach(const QString& symbol, symbols) 
+    RemoveSymbol(symbol);
+}
+
+// source: data changed
+void VioSymbolWorld::SourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight) {
+  if(topLeft.parent().isValid() || !mSourceSynced) return;
+  if(topLeft.column() > mSymbolSourceColumn) return;
+  if(bottomRight.column() < mSymbolSourceColumn) return;
+  if(bottomRight.row()>=mSourceSymbols.size()) { SourceReset(); return; }
+  for(int row=topLeft.row(); row<=bottomRight.row(); row++) {
+    QString symbol=SourceSymbol(row);
+    if(symbol==mSourceSymbols.at(row)) continue;
+    FD_DQ("VioSymbolWorld::SourceDataChanged("<<this << "): row " << row << ": " << 
+      VioStyle::StrFromQStr(symbol));
+    RemoveSymbol(mSourceSymbols.at(row));
+    InsertSymbol(symbol);
+    mSourceSymbols[row]=symbol;
+  }
+}
+
+// source: structural change
+void VioSymbolWorld::SourceReset(void) {
+  mSourceSynced=false;
+  Update();
+}
+
+// test for prefix of known symbol (binary search)
+bool VioSymbolWorld::isSymbolPrefix(const QString& rPrefix) const {
+  const QStringList world=mSymbolWorld->stringList();
+  QStringList::const_iterator pit=qLowerBound(world.begin(),world.end(),rPrefix);
+  if(pit==world.end()) return false;
+  return pit->startsWith(rPrefix);
+}
+
+// helper: pack a character trigram
+static quint64 SearchGram(const QChar* pc) {
+  return (((quint64) pc[0].unicode()) << 32) | (((quint64) pc[1].unicode()) << 16) | pc[2].unicode();
+}
+
+// helper: test for subsequence
+static bool SearchSubsequence(const QString& rQuery, const QString& rKey) {
+  int pos=0;
+  for(int i=0; i<rQuery.size(); i++) {
+    pos=rKey.indexOf(rQuery.at(i),pos);
+    if(pos<0) return false;
+    pos++;
+  }
+  return true;
+}
+
+// helper: search candidate with rank (lower is better)
+class VioSymbolMatch {
+public:
+  int mRank;
+  int mOverlap;
+  int mId;
+  const QString* pKey;
+  bool operator<(const VioSymbolMatch& other) const {
+    if(mRank!=other.mRank) return mRank < other.mRank;
+    if(mOverlap!=other.mOverlap) return mOverlap > other.mOverlap;
+    if(pKey->size()!=other.pKey->size()) return pKey->size() < other.pKey->size();
+    return *pKey < *other.pKey;
+  }
+};
+
+// helper: rank a candidate
+static int SearchRank(const QString& rQuery, const QString& rKey) {
+  if(rKey==rQuery) return 0;
+  if(rKey.startsWith(rQuery)) return 1;
+  if(rKey.contains(rQuery)) return 2;
+  if(SearchSubsequence(rQuery,rKey)) return 3;
+  return 4;
+}
+
+// search index: build from scratch
+void VioSymbolWorld::SearchIndexBuild(void) const {
+  FD_DQ("VioSymbolWorld::SearchIndexBuild("<<this << "): #" << mSymbolCount.size());
+  mSearchSymbols.clear();
+  mSearchKeys.clear();
+  mSearchIds.clear();
+  mSearchGrams.clear();
+  mSearchHoles=0;
+  mSearchSymbols.reserve(mSymbolCount.size());
+  mSearchKeys.reserve(mSymbolCount.size());
+  mSearchIds.reserve(mSymbolCount.size());
+  mSearchValid=true;
+  foreach(const QString& symbol, mSymbolWorld->stringList()) 
+    SearchIndexInsert(symbol);
+}
+
+// search index: insert symbol
+void VioSymbolWorld::SearchIndexInsert(const QString& rSymbol) const {
+  if(mSearchIds.contains(rSymbol)) return;
+  int id=mSearchSymbols.size();
+  QString key=rSymbol.toLower();
+  mSearchSymbols.append(rSymbol);
+  mSearchKeys.append(key);
+  mSearchIds.insert(rSymbol,id);
+  // record each trigram once per symbol
+  QSet<quint64> grams;
+  for(int i=0; i+3<=key.size(); i++) 
+    grams.insert(SearchGram(key.constData()+i));
+  foreach(quint64 gram, grams)
+    mSearchGrams[gram].append(id);
+}
+
+// search index: remove symbol (leave a hole, rebuild when there are too many)
+void VioSymbolWorld::SearchIndexRemove(const QString& rSymbol) const {
+  QHash<QString,int>::iterator iit=mSearchIds.find(rSymbol);
+  if(iit==mSearchIds.end()) return;
+  mSearchSymbols[iit.value()]=QString();
+  mSearchKeys[iit.value()]=QString();
+  mSearchIds.erase(iit);
+  if(++mSearchHoles > 1000 && mSearchHoles > mSearchSymbols.size()/2) 
+    mSearchValid=false;
+}
+
+// search: top k matches, ranked
+QStringList VioSymbolWorld::Search(const QString& rQuery, int k) const {
+  QStringList res;
+  QString query=rQuery.trimmed().toLower();
+  // trivial case: first k symbols
+  if(query.isEmpty()) {
+    const QStringList world=mSymbolWorld->stringList();
+    return world.mid(0,k);
+  }
+  // have index
+  if(!mSearchValid) SearchIndexBuild();
+  // collect candidates
+  QVector<VioSymbolMatch> cands;
+  if(query.size()<3) {
+    // short query: scan for substrings
+    for(int id=0; id<mSearchKeys.size(); id++) {
+      const QString& key=mSearchKeys.at(id);
+      if(key.isNull()) continue;
+      if(!key.contains(query)) continue;
+      VioSymbolMatch match;
+      match.mRank=SearchRank(query,key);
+      match.mOverlap=0;
+      match.mId=id;
+      match.pKey=&key;
+      cands.append(match);
+    }
+  } else {
+    // long query: count trigram hits per symbol
+    QSet<quint64> grams;
+    for(int i=0; i+3<=query.size(); i++) 
+      grams.insert(SearchGram(query.constData()+i));
+    int threshold=(grams.size()+1)/2;
+    for(int id=mSearchHits.size(); id<mSearchKeys.size(); id++) 
+      mSearchHits.append(0);
+    QVector<int> touched;
+    foreach(quint64 gram, grams) {
+      QHash<quint64, QVector<int> >::const_iterator git=mSearchGrams.find(gram);
+      if(git==mSearchGrams.end()) continue;
+      const QVector<int>& ids=git.value();
+      for(int i=0; i<ids.size(); i++) 
+        if(mSearchHits[ids.at(i)]++ == 0) touched.append(ids.at(i));
+    }
+    foreach(int id, touched) {
+      int hits=mSearchHits.at(id);
+      mSearchHits[id]=0;
+      if(hits<threshold) continue;
+      const QString& key=mSearchKeys.at(id);
+      if(key.isNull()) continue;
+      VioSymbolMatch match;
+      match.mRank=SearchRank(query,key);
+      match.mOverlap=hits;
+      match.mId=id;
+      match.pKey=&key;
+      cands.append(match);
+    }
+  }
+  // top k
+  int n=qMin(k,cands.size());
+  std::partial_sort(cands.begin(),cands.begin()+n,cands.end());
+  for(int i=0; i<n; i++) 
+    res.append(mSearchSymbols.at(cands.at(i).mId));
+  FD_DQ("VioSymbolWorld::Search("<<this << "): " << VioStyle::StrFromQStr(rQuery) << 
+    ": #" << cands.size() << " candidates");
+  return res;
+}
+
+
+// construct
+VioSymbolCompleter::VioSymbolCompleter(QObject *parent) : QCompleter(parent) {
+  mOwnWorld= new VioSymbolWorld(this);
+  pWorld=mOwnWorld;
+  mSearchMode=false;
+  mSearchCount=20;
+  mSearchResults= new QStringListModel(this);
+  setModel(pWorld->Model());
   setCompletionMode(QCompleter::InlineCompletion);
+  // the world is sorted, so the completer may use binary search
+  setCaseSensitivity(Qt::CaseSensitive);
+  setModelSorting(QCompleter::CaseSensitivelySortedModel);
 }
 
 // destruct
 VioSymbolCompleter::~VioSymbolCompleter(void) {
   FD_DQ("VioSymbolCompleter:::~VioSymbolCompleter()");
   setModel(0);
-  delete mSymbolWorld;
+  if(pWorld!=mOwnWorld) VioSymbolWorld::Release(pWorld);
   FD_DQ("VioSymbolCompleter:::~VioSymbolCompleter(): done");
 }
 
@@ -432,8 +819,8 @@ VioSymbolCompleter::~VioSymbolCompleter(void) {
 void VioSymbolCompleter::setSymbolWorld(const QStringList& rStringList) {
   FD_DQ("VioSymbolCompleter::setSymbolWorld("<<this << "): from stringlist");
   clrSymbolWorld();
-  mSymbolWorld->setStringList(rStringList);
-  setModel(mSymbolWorld);
+  pWorld->setSymbols(rStringList);
+  UpdateModel();
   FD_DQ("VioSymbolCompleter::setSymbolWorld("<<this << "): from stringlist: done #" << rStringList.size());
 };
 
@@ -445,54 +832,83 @@ void VioSymbolCompleter::setSymbolWorld(const faudes::EventSet& rEventSet) {
   setSymbolWorld(strings);
 };
 
-
 // source: other model
 void VioSymbolCompleter::setSymbolWorld(QAbstractItemModel* pStringModel, int col) {
   clrSymbolWorld();
-  pSymbolSource=pStringModel;
-  mSymbolSourceColumn=col;
-  Update();
+  pWorld->setSource(pStringModel,col);
+  UpdateModel();
+};
+
+// source: shared world
+void VioSymbolCompleter::setSharedSymbolWorld(const QString& rKey) {
+  FD_DQ("VioSymbolCompleter::setSharedSymbolWorld("<<this << "): " << VioStyle::StrFromQStr(rKey));
+  clrSymbolWorld();
+  pWorld=VioSymbolWorld::Acquire(rKey);
+  UpdateModel();
+};
+
+// source: shared world, set symbols if we are the first user
+void VioSymbolCompleter::setSharedSymbolWorld(const QString& rKey, const QStringList& rStringList) {
+  setSharedSymbolWorld(rKey);
+  if(pWorld->source() || pWorld->Model()->rowCount()>0) return;
+  pWorld->setSymbols(rStringList);
 };
 
 // update from source
 void VioSymbolCompleter::Update(void) {
-  if(!pSymbolSource) return;
-  FD_DQ("VioSymbolCompleter::Update("<<this << "): from model with #" << pSymbolSource->rowCount()
-	<< " at column " << mSymbolSourceColumn);
-  // careful resize/update since my model can be usd somewhere else to
-  if(mSymbolWorld->rowCount() > pSymbolSource->rowCount())
-    mSymbolWorld->removeRows(pSymbolSource->rowCount(),
-      mSymbolWorld->rowCount()-pSymbolSource->rowCount());
-  if(mSymbolWorld->rowCount() < pSymbolSource->rowCount())
-    mSymbolWorld->insertRows(mSymbolWorld->rowCount(),
-      pSymbolSource->rowCount()-mSymbolWorld->rowCount());
-  QModelIndex source, dest;
-  int count=0;
-  for(int row=0; row < pSymbolSource->rowCount(); row++) {
-    source=pSymbolSource->index(row,mSymbolSourceColumn);
-    if(!source.isValid()) continue;
-    QVariant symbol= pSymbolSource->data(source);
-    if(!VioStyle::ValidSymbol(symbol.toString())) continue;
-    dest = mSymbolWorld->index(count);
-    if(!dest.isValid()) continue;
-    mSymbolWorld->setData(dest,symbol);
-    count++;
-    FD_DQ("VioSymbolCompleter::Update("<<this << "): symbol " << 
-	  VioStyle::StrFromQStr(symbol.toString()));
-  } 
-  // todo: we should (optionaly) run sort on it ...  
-  mSymbolWorld->removeRows(count,mSymbolWorld->rowCount()-count);
-  setModel(mSymbolWorld);
-  FD_DQ("VioSymbolCompleter::Update("<<this << "): results in #" << mSymbolWorld->rowCount());
+  pWorld->Update();
 }
 
 // release mem
 void VioSymbolCompleter::clrSymbolWorld(void) {
   setModel(0);
-  mSymbolWorld->removeRows(0,mSymbolWorld->rowCount());
-  pSymbolSource=0;
+  if(pWorld!=mOwnWorld) VioSymbolWorld::Release(pWorld);
+  pWorld=mOwnWorld;
+  pWorld->Clear();
+  UpdateModel();
 };
 
+// set model according to mode
+void VioSymbolCompleter::UpdateModel(void) {
+  if(mSearchMode) {
+    mSearchResults->setStringList(QStringList());
+    setModel(mSearchResults);
+  } else {
+    setModel(pWorld->Model());
+  }
+}
+
+// search mode
+void VioSymbolCompleter::setSearchMode(bool on, int k) {
+  mSearchMode=on;
+  mSearchCount=k;
+  if(mSearchMode) {
+    setModelSorting(QCompleter::UnsortedModel);
+    setCompletionMode(QCompleter::PopupCompletion);
+    setMaxVisibleItems(qMin(k,10));
+  } else {
+    setModelSorting(QCompleter::CaseSensitivelySortedModel);
+    setCompletionMode(QCompleter::InlineCompletion);
+  }
+  UpdateModel();
+}
+
+// reimplement qcompleter: have search results as model, all of which match the empty path
+QStringList VioSymbolCompleter::splitPath(const QString& path) const {
+  if(!mSearchMode) return QCompleter::splitPath(path);
+  return QStringList() << QString();
+}
+
+// search mode: run search on user edits and pop up results
+void VioSymbolCompleter::SearchEdited(const QString& text) {
+  if(!mSearchMode) return;
+  // shared completers: ignore editors we are no longer attached to
+  if(sender() && sender()!=widget()) return;
+  mSearchResults->setStringList(pWorld->Search(text,mSearchCount));
+  complete();
+}
+
+
 
 
 
@@ -581,6 +997,9 @@ void VioSymbolDelegate::setModelData(QWidget *editor, QAbstractItemModel *model,
 {
   VioSymbolEdit* symedit = static_cast<VioSymbolEdit*>(editor);
   QString symbol= symedit->symbol();
+  // reject unknown symbols
+  if(symedit->symbolMode() & VioSymbol::KnownSymbolsOnly)
+    if(symbol!="" && !symedit->validate()) return;
   model->setData(index, symbol);
 }
 
@@ -738,15 +1157,13 @@ void VioSymbolTableWidget::setDimensions(int rows, int cols) {
   // clear model
   if(rows!=rowCount()) {
     // remove all lines
-    while(mModel.rowCount()>0) mModel.removeRow(0);
+    mModel.removeRows(0,mModel.rowCount());
     // set new length
     mModel.setRowCount(rows);
     // fill
-    for(int i=0; i< rows; i++) 
-    for(int j=0; j< cols; j++) {
-      QModelIndex index = mModel.index(i,j);
-      mModel.setData(index,QString(""),Qt::EditRole);
-    }
+    QStringList empty;
+    for(int i=0; i< rows; i++) empty.append(QString(""));
+    for(int j=0; j< cols; j++) DoSetColumn(j,empty);
   }
   // enable sorting now
   setSortingEnabled(true);
@@ -802,6 +1219,14 @@ void VioSymbolTableWidget::setSymbolWorld(int col, QAbstractItemModel* pStringMo
   mpCompleters[col]->setSymbolWorld(pStringModel,srccol);
 }
 
+// set base set
+void VioSymbolTableWidget::setSharedSymbolWorld(int col, const QString& rKey, const QStringList& rStringList) {
+  if(col <0 || col >= mModel.columnCount()) return;
+  FD_DQ("VioSymbolTableWidget::setSharedSymbolWorld(): " << VioStyle::StrFromQStr(rKey));
+  if(rStringList.isEmpty()) mpCompleters[col]->setSharedSymbolWorld(rKey);
+  else mpCompleters[col]->setSharedSymbolWorld(rKey,rStringList);
+}
+
 // set base set  (single column convenience)
 void VioSymbolTableWidget::setSymbolWorld(QCompleter* completer) {
   setSymbolWorld(0,completer);}
@@ -814,6 +1239,9 @@ void VioSymbolTableWidget::setSymbolWorld(const faudes::NameSet& rNameSet) {
 // set base set  (single column convenience)
 void VioSymbolTableWidget::setSymbolWorld(QAbstractItemModel* pStringModel, int srccol) {
   setSymbolWorld(0,pStringModel,srccol);}
+// set base set  (single column convenience)
+void VioSymbolTableWidget::setSharedSymbolWorld(const QString& rKey, const QStringList& rStringList) {
+  setSharedSymbolWorld(0,rKey,rStringList);}
 
  
 // set item
@@ -843,21 +1271,30 @@ QString VioSymbolTableWidget::Symbol(int row, int col) const {
 // set column
 void VioSymbolTableWidget::setSymbolColumn(int col, const QStringList& rStringList) {
   if(col <0 || col >= mModel.columnCount()) return;
-  FD_DQ("VioSymbolTableWidget::setSymbolColumn(" << col << "): by stringlist");
+  FD_DQ("VioSymbolTableWidget::setSymbolColumn(" << col << "): by stringlist #" << rStringList.size());
+  setSortingEnabled(false);
   // leader col: truncate/extend
   if(col==0) {
-    setSortingEnabled(false);
-    while(mModel.rowCount()>rStringList.size()) mModel.removeRow(mModel.rowCount()-1);
+    if(mModel.rowCount()>rStringList.size()) 
+      mModel.removeRows(rStringList.size(),mModel.rowCount()-rStringList.size());
     mModel.setRowCount(rStringList.size());
-    setSortingEnabled(true);
   }
   // copy items
-  for(int pos=0; pos < rStringList.size(); pos ++) {
-    QModelIndex index = mModel.index(pos,col);
-    mModel.setData(index,rStringList[pos],Qt::EditRole);
-  }
+  DoSetColumn(col,rStringList);
+  setSortingEnabled(true);
 };
 
+// update column items in place (rows beyond the list keep their items)
+void VioSymbolTableWidget::DoSetColumn(int col, const QStringList& rStringList) {
+  int rows=qMin(mModel.rowCount(),rStringList.size());
+  for(int pos=0; pos < rows; pos++) {
+    QStandardItem* item=mModel.item(pos,col);
+    if(!item) { mModel.setItem(pos,col,new QStandardItem(rStringList.at(pos))); continue; }
+    // notify only on actual changes
+    if(item->text()!=rStringList.at(pos)) item->setText(rStringList.at(pos));
+  }
+}
+
 // set column (single column version)
 void VioSymbolTableWidget::setSymbolList(const QStringList& rStringList) {
   setSymbolColumn(0,rStringList);
@@ -909,12 +1346,36 @@ void VioSymbolTableWidget::toNameSet(faudes::EventSet& rNameSet) const {
 
 // set strings from event set
 void VioSymbolTableWidget::setEventSetColumn(int col, const faudes::EventSet& rEventSet) {
-  FD_DQ("VioSymbolTableWidget::setEventSetColumn(): to eventset " << rEventSet.ToString());
+  FD_DQ("VioSymbolTableWidget::setEventSetColumn(): to eventset #" << rEventSet.Size());
   QStringList strings;
   VioStyle::EventsQStrList(strings,&rEventSet);
   setSymbolColumn(col, strings);
 }
 
+// merge strings from event set (one pass, new symbols are appended)
+void VioSymbolTableWidget::mergeEventSetColumn(int col, const faudes::EventSet& rEventSet) {
+  if(col <0 || col >= mModel.columnCount()) return;
+  FD_DQ("VioSymbolTableWidget::mergeEventSetColumn(): #" << rEventSet.Size());
+  QStringList strings=symbolColumn(col);
+  QSet<QString> known=strings.toSet();
+  QStringList add;
+  VioStyle::EventsQStrList(add,&rEventSet);
+  foreach(const QString& str, add) 
+    if(!known.contains(str)) strings.append(str);
+  if(strings.size()==mModel.rowCount()) return;
+  setSymbolColumn(col, strings);
+}
+
+// subtract strings from event set (one pass)
+void VioSymbolTableWidget::subtractEventSetColumn(int col, const faudes::EventSet& rEventSet) {
+  if(col <0 || col >= mModel.columnCount()) return;
+  FD_DQ("VioSymbolTableWidget::subtractEventSetColumn(): #" << rEventSet.Size());
+  QStringList strings;
+  foreach(const QString& str, symbolColumn(col)) 
+    if(!rEventSet.Exists(VioStyle::StrFromQStr(str))) strings.append(str);
+  if(strings.size()==mModel.rowCount()) return;
+  setSymbolColumn(col, strings);
+}
 
 // set strings from event set (single column)
 void VioSymbolTableWidget::setEventSet(const faudes::EventSet& rEventSet) {
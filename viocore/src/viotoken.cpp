@@ -22,61 +22,62 @@
 
 // parse block of tokens
 void VioTokenParser(const QTextBlock& block, VioTokenHighlighter::BlockData* newstate, int position=-1) {
-  // search regex (is static ok ??)
-  static QRegExp mTagExpression("<[^>]*>");
-  // have an accumulator, initialise with previous state
+  // have an accumulator, initialise with previous state (shares the section stack)
   VioTokenHighlighter::BlockData* state = 0;
   state = dynamic_cast< VioTokenHighlighter::BlockData* >( block.previous().userData() );
   if(state) *newstate=*state;
   state = newstate;
-  FD_DQ("VioTokenParser(): state #" << state->mSectionVector.size());
+  VioSectionStack<VioTokenHighlighter::SectionInfo>& stack = state->mSectionStack;
+  FD_DQ("VioTokenParser(): state #" << stack.Size());
   // clear position result
   state->mBeginTag.mName="";
   state->mEndTag.mName="";
-  // parse this block for tags
+  // parse this block for tags <...>
   QString text= block.text();
   int offset=block.position();
   FD_DQ("VioTokenParser(): block " << block.blockNumber() << " text " << VioStyle::StrFromQStr(text));
-  int index = mTagExpression.indexIn(text);
+  int index = text.indexOf('<');
   while(index >= 0) {
-    int length = mTagExpression.matchedLength();
-    QString match = text.mid(index,length);        
+    int close = text.indexOf('>',index+1);
+    if(close<0) break;
+    int length = close-index+1;
     // end section tag 
     if(length>3) 
-    if(match.at(1)==QChar('/')) {
+    if(text.at(index+1)==QChar('/')) {
       QString label = text.mid(index+2,length-3);         
       FD_DQ("VioTokenParser(): end " << VioStyle::StrFromQStr(label) << " tag at " << 
         index << " (#" << length <<")");
       if(position >= offset+index)
       if(position <  offset+index+length) {
         FD_DQ("VioTokenParser(): end label at current position");
-     	state->mEndTag.mPosition = offset+index;
+     	state->mEndTag.mBlock = block;
+     	state->mEndTag.mOffset = index;
 	state->mEndTag.mLength = length;
         state->mEndTag.mName = label;
-        if(state->mSectionVector.size()>0)
-          state->mBeginTag=state->mSectionVector.back();
+        if(!stack.Empty())
+          state->mBeginTag=stack.Top();
       }
       // pop matching begin tag
-      if(state->mSectionVector.size()>0)
-      if(state->mSectionVector.back().mName == label) {
+      if(!stack.Empty())
+      if(stack.Top().mName == label) {
         FD_DQ("VioTokenParser(): pop matching begin " << VioStyle::StrFromQStr(label));
-        state->mSectionVector.pop_back();        
+        stack.Pop();        
       }
     }
     // begin section tag 
     if(length>2) 
-    if(match.at(1)!=QChar('/')) {
-      QString label = text.mid(index+1,length-2);         
-      FD_DQ("VioTokenParser(): begin " << VioStyle::StrFromQStr(label) << " tag at " << 
-        index << " (#" << length <<")");
+    if(text.at(index+1)!=QChar('/')) {
       VioTokenHighlighter::SectionInfo sinfo;
-      sinfo.mName=label;
-      sinfo.mPosition=offset+index;
+      sinfo.mName=text.mid(index+1,length-2);
+      FD_DQ("VioTokenParser(): begin " << VioStyle::StrFromQStr(sinfo.mName) << " tag at " << 
+        index << " (#" << length <<")");
+      sinfo.mBlock=block;
+      sinfo.mOffset=index;
       sinfo.mLength=length;
-      state->mSectionVector.push_back(sinfo);
+      stack.Push(sinfo,qHash(sinfo.mName)*31 + sinfo.mOffset);
     }
     // proceed with next match
-    index = mTagExpression.indexIn(text, index + length);
+    index = text.indexOf('<',close+1);
   }
 }
 
@@ -121,16 +122,15 @@ VioTokenHighlighter::VioTokenHighlighter(QTextDocument *parent)
   rule.format = mBinaryFormat;
   mHighlightingRules.append(rule);
 
-  mTagExpression = QRegExp("<[^>]*>");
-
 }
 
 // re-implement highlighting
 void VioTokenHighlighter::highlightBlock(const QString &text) {
 
-  // test rules for std highlighting
-  foreach(const HighlightingRule &rule, mHighlightingRules) {
-    QRegExp expression(rule.pattern);
+  // test rules for std highlighting (precompiled, no copies)
+  for(int i=0; i<mHighlightingRules.size(); i++) {
+    const HighlightingRule& rule=mHighlightingRules.at(i);
+    const QRegExp& expression=rule.pattern;
     int index = expression.indexIn(text);
     while (index >= 0) {
       int length = expression.matchedLength();
@@ -144,9 +144,8 @@ void VioTokenHighlighter::highlightBlock(const QString &text) {
   VioTokenParser(currentBlock(),newstate);
   setCurrentBlockUserData(newstate);
 
-  // toggle state to trigger subsequent updates
-  // todo: only when state changed
-  setCurrentBlockState( currentBlockState()>0 ? 0 : 1);
+  // set qt state: subsequent blocks are updated only if this differs from before
+  setCurrentBlockState( newstate->mSectionStack.Hash() & 0x7fffffff );
 
 
 }
@@ -274,7 +273,7 @@ void VioTokenEditor::TrackCursor(void) {
   const QTextBlock& block = cursor.block();
   VioTokenHighlighter::BlockData posstate;
   VioTokenParser(block,&posstate,cursor.position());  
-  FD_DQ("VioTokenEditorTrackCursor(): posstate #" << posstate.mSectionVector.size());
+  FD_DQ("VioTokenEditorTrackCursor(): posstate #" << posstate.mSectionStack.Size());
   // set visual feed back
   QList<QTextEdit::ExtraSelection> xsellist;
   QTextEdit::ExtraSelection xselect;
@@ -285,16 +284,16 @@ void VioTokenEditor::TrackCursor(void) {
     xselect.format=mTagMissFormat;
   // visual end tag
   if(posstate.mEndTag.mName!="") {
-    FD_DQ("VioTokenHighlighter(): found cursor at end label pos " << posstate.mEndTag.mPosition);
-    xselect.cursor.setPosition(posstate.mEndTag.mPosition,QTextCursor::MoveAnchor);
-    xselect.cursor.setPosition(posstate.mEndTag.mPosition+posstate.mEndTag.mLength,QTextCursor::KeepAnchor);
+    FD_DQ("VioTokenHighlighter(): found cursor at end label pos " << posstate.mEndTag.Position());
+    xselect.cursor.setPosition(posstate.mEndTag.Position(),QTextCursor::MoveAnchor);
+    xselect.cursor.setPosition(posstate.mEndTag.Position()+posstate.mEndTag.mLength,QTextCursor::KeepAnchor);
     xsellist.append(xselect);
   }
   // visual begin tag
-  if(posstate.mBeginTag.mName!="") {
-    FD_DQ("VioTokenHighlighter(): found relevant begin label pos " << posstate.mBeginTag.mPosition);
-    xselect.cursor.setPosition(posstate.mBeginTag.mPosition,QTextCursor::MoveAnchor);
-    xselect.cursor.setPosition(posstate.mBeginTag.mPosition+posstate.mBeginTag.mLength,QTextCursor::KeepAnchor);
+  if(posstate.mBeginTag.mName!="" && posstate.mBeginTag.Position()>=0) {
+    FD_DQ("VioTokenHighlighter(): found relevant begin label pos " << posstate.mBeginTag.Position());
+    xselect.cursor.setPosition(posstate.mBeginTag.Position(),QTextCursor::MoveAnchor);
+    xselect.cursor.setPosition(posstate.mBeginTag.Position()+posstate.mBeginTag.mLength,QTextCursor::KeepAnchor);
     xsellist.append(xselect);
   }
   // apply
@@ -200,7 +200,9 @@ VioModel::VioModel(QObject* parent, VioStyle* config, bool alloc) :
   mData(0),
   mFaudesLocked(false),   
   mFaudesType(""),
-  mModified(false)
+  mModified(false),
+  mRevision(0),
+  mDataRevision(0)
 {
   // make sure we are configured
   if(!pConfig) pConfig=VioStyle::G();
@@ -305,8 +307,10 @@ VioStyle* VioModel::Configuration(void) const {
 // clear to default/empty faudes object
 void VioModel::Clear(void) {
   FD_DQT("VioModel::Clear(): type " << mFaudesType);
+  AboutToChange();
   mData->Clear();
   DoVioUpdate();
+  emit NotifyJournal(QByteArray());
 }
 
 // type info
@@ -322,17 +326,20 @@ int VioModel::InsertFaudesObject(faudes::Type* fobject) {
     FD_DQT("VioModel::InsertFaudesObject(" << fobject <<"): unlock");
     mFaudesLocked=false;
     DoVioUpdate();
+    emit NotifyJournal(QByteArray());
     return 0;
   }
   // type check
   if(DoTypeCheck(fobject)) return 1;
   FD_DQT("VioModel::InsertFaudesObject(" << fobject <<"): delete/set");
+  AboutToChange();
   // set to new faudes object
   mData->FaudesObject(fobject);
   mFaudesLocked=false;
   // update grapical representation data
   FD_DQT("VioModel::InsertFaudesObject(" << fobject <<"): update models and views");
   DoVioUpdate();
+  emit NotifyJournal(QByteArray());
   // done
   FD_DQT("VioModel::InsertFaudesObject(" << fobject <<"): done " << mFaudesType);
   return 0;
@@ -367,6 +374,7 @@ const faudes::Type* VioModel::FaudesObject(void) const {
 // get faudes object with write access
 faudes::Type* VioModel::TakeFaudesObject(void) { 
   FD_DQT("VioModel::TakeFaudesObject(): get writable faudes object refernce");
+  AboutToChange();
   mFaudesLocked=true;
   return mData->FaudesObject(); 
 }
@@ -385,8 +393,10 @@ QString VioModel::FaudesName(void) const {
 void VioModel::FaudesName(const QString& rName) {
   std::string fname = VioStyle::StrFromQStr(rName);
   if(mData->FaudesObject()->Name()==fname) return;
+  AboutToChange();
   mData->FaudesObject()->Name(fname);
   emit NotifyNameChange();
+  emit NotifyJournal(QByteArray());
 }
 
 // token io: write tokenwriter
@@ -484,8 +494,20 @@ void VioModel::ExportFaudesFile(const QString& rFileName) const {
 }
 
 
+// graphics export (not supported by default)
+int VioModel::ExportGraphics(const QString& rFileName) const {
+  (void) rFileName;
+  return 1;
+}
+
+// automatic layout (not supported by default)
+int VioModel::AutoLayout(void) {
+  return 1;
+}
+
 // token io: faudes read from file
 void VioModel::ImportFaudesFile(const QString& rFileName) {
+  AboutToChange();
   faudes::TokenReader tr(VioStyle::LfnFromQStr(rFileName));
   mData->FaudesObject()->Read(tr);
   DoVioUpdate();
@@ -595,6 +617,7 @@ int VioModel::TypeCheckData(const VioData* pData) {
 // set typed viodata
 void VioModel::VioText(const QString& text) {
   FD_DQT("VioModel::VioText(): set text \"" << text<<"\"");
+  if(text!=mData->mText) AboutToChange();
   // apply on representation data
   mData->mText=text;
   // apply on faudes object (may throw an expection)
@@ -614,6 +637,7 @@ const QString& VioModel::VioText(void) const {
 void VioModel::SelectionClear(void) {
   FD_DQT("VioModel::SelectionClear(): #" << mSelection.size());
   bool changed= (mSelection.size()!=0);
+  if(changed) AboutToChange(true);
   mSelection.clear();
   if(changed) emit NotifySelectionClear();
 }
@@ -639,6 +663,7 @@ void VioModel::Select(const VioElement& elem, bool on) {
   // test for actual changes
   bool contained=mSelection.contains(elem);
   bool changed= (contained!=on);
+  if(changed) AboutToChange(true);
   // do it
   if(contained && !on) mSelection.removeAll(elem);
   if(!contained && on) mSelection.append(elem);
@@ -653,6 +678,29 @@ bool VioModel::Modified(void) const {
   return mModified;
 };
 
+// query revision
+int VioModel::Revision(void) const { 
+  return mRevision;
+};
+
+// query data revision
+int VioModel::DataRevision(void) const { 
+  return mDataRevision;
+};
+
+// announce changes: last chance for lazy clients to take a snapshot
+void VioModel::AboutToChange(bool selection) { 
+  emit NotifyAboutToChange();
+  mRevision++;
+  if(!selection) mDataRevision++;
+};
+
+// change journal: replay (not supported by default)
+int VioModel::JournalReplay(const QByteArray& rRecord) { 
+  (void) rRecord;
+  return 1;
+};
+
 // collect and pass on modifications of childs
 void VioModel::ChildModified(bool changed) { 
   // ignre netagtives
@@ -798,6 +846,8 @@ void VioModel::UndoStackPushBack(void) {
 // state based undo scheme: user starts editing
 void VioModel::UndoEditStart(void) {
   FD_DQT("VioModel::UserEditStart()");
+  // user is about to edit
+  AboutToChange();
   // edit in progess
   if(mUndoEditLevel>0) {
     mUndoEditLevel++;
@@ -864,6 +914,8 @@ void VioModel::Undo(void) {
   // there is no more to undo
   if(mUndoCurrent==0 || mUndoStack.size()==0) 
     return;
+  // about to change
+  AboutToChange();
   // record state at first undo
   if(mUndoCurrent==-1) {
     UndoStackPushBack();
@@ -887,6 +939,7 @@ void VioModel::Redo(void) {
   if(mUndoCurrent+1 >=0) 
   if(mUndoCurrent+1 < mUndoStack.size()) 
   {
+    AboutToChange();
     mUndoCurrent++;
     FD_DQT("VioModel::Redo() #" << mUndoStack.size() << " at " << mUndoCurrent); 
     Data(mUndoStack.at(mUndoCurrent));
@@ -914,6 +967,7 @@ VioView::VioView(QWidget* parent, VioStyle* config, bool alloc) :
   pConfig(config),
   pModel(0), 
   mModified(false),
+  mLazyCopy(false),
   mTextInfo(0),
   mTextEdit(0),
   mApplyButton(0)
@@ -1232,6 +1286,11 @@ int VioView::TestMimeData(const QMimeData* pMimeData) {
   return vdat->TestMime(pMimeData);
 }
 
+// mime formats: all VioData encode as text
+QStringList VioView::MimeFormats(void) const {
+  return QStringList() << "text/plain";
+}
+
 // mime data access
 int VioView::InsertMimeData(const QMimeData* pMimeData) {
   if(!pModel) return 1;
@@ -1261,7 +1320,9 @@ void VioView::Cut(void) {
   if(pModel->Selection().size()==0) return;
   FD_DQT("VioView::Cut()");
   pModel->UndoEditStart();
-  QMimeData* mdat=SelectionMimeData();
+  // we need the data before deletion, but the mime encoding can wait
+  VioLazyMimeData* mdat=new VioLazyMimeData(this);
+  mdat->Materialize();
   QApplication::clipboard()->setMimeData(mdat);
   DeleteSelection();
   pModel->UndoEditStop();
@@ -1272,7 +1333,9 @@ void VioView::Cut(void) {
 void VioView::Copy(void) {
   if(!pModel) return;
   FD_DQT("VioView::Copy()");
-  QMimeData* mdat=SelectionMimeData();
+  // record reference only; views with a text based selection must extract now
+  VioLazyMimeData* mdat=new VioLazyMimeData(this);
+  if(!mLazyCopy) mdat->Materialize();
   QApplication::clipboard()->setMimeData(mdat);
   FD_DQT("VioView::Copy():done");
 }
@@ -1353,6 +1416,100 @@ int VioView::ApplyFaudesFunction(const QString& ffnct) {
 
 
 
+/*
+****************************************************************
+****************************************************************
+****************************************************************
+
+Implementation: VioLazyMimeData
+
+****************************************************************
+****************************************************************
+****************************************************************
+*/
+
+// construct
+VioLazyMimeData::VioLazyMimeData(VioView* view) :
+  QMimeData(),
+  pView(view),
+  pModel(0),
+  mRevision(-1),
+  mData(0),
+  mMimeData(0)
+{
+  FD_DQT("VioLazyMimeData::VioLazyMimeData()");
+  // record formats
+  if(pView) mFormats=pView->MimeFormats();
+  // record model and revision
+  if(pView) pModel=const_cast<VioModel*>(pView->Model());
+  if(!pModel) return;
+  mRevision=pModel->Revision();
+  // take snapshot on upcomming changes
+  connect(pModel,SIGNAL(NotifyAboutToChange(void)),this,SLOT(Materialize(void)));
+}
+
+// destruct
+VioLazyMimeData::~VioLazyMimeData(void) {
+  if(mData) delete mData;
+  if(mMimeData) delete mMimeData;
+}
+
+// test for snapshot
+bool VioLazyMimeData::IsMaterialized(void) const {
+  return mData!=0;
+}
+
+// take snapshot
+void VioLazyMimeData::Materialize(void) {
+  // bail out if we have the data
+  if(mData) return;
+  // bail out on invalid source 
+  if(!pView || !pModel) return;
+  // bail out on stale revision (should not happen, we are notified before any change)
+  if(pModel->Revision()!=mRevision) {
+    FD_DQT("VioLazyMimeData::Materialize(): stale revision");
+    disconnect(pModel,0,this,0);
+    pModel=0;
+    return;
+  }
+  // extract data
+  FD_DQT("VioLazyMimeData::Materialize(): extract data at revision " << mRevision);
+  mData=pView->SelectionData();
+  // release source
+  disconnect(pModel,0,this,0);
+  pModel=0;
+  pView=0;
+}
+
+// formats we provide: as reported by the view
+QStringList VioLazyMimeData::formats(void) const {
+  return mFormats;
+}
+
+// formats we provide
+bool VioLazyMimeData::hasFormat(const QString& mimetype) const {
+  return formats().contains(mimetype);
+}
+
+// generate data on request 
+QVariant VioLazyMimeData::retrieveData(const QString& mimetype, QVariant::Type type) const {
+  FD_DQT("VioLazyMimeData::retrieveData(): " << mimetype);
+  (void) type;
+  // have non-const ref (qt requests via const interface)
+  VioLazyMimeData* fthis=const_cast<VioLazyMimeData*>(this);
+  // extract vio data and encode 
+  fthis->Materialize();
+  if(!mData) return QVariant();
+  if(!mMimeData) fthis->mMimeData=mData->ToMime();
+  if(!mMimeData) return QVariant();
+  // pass on
+  if(!mMimeData->hasFormat(mimetype)) return QVariant();
+  if(mimetype=="text/plain") return QVariant(mMimeData->text());
+  return QVariant(mMimeData->data(mimetype));
+}
+
+
+
 /*
 ****************************************************************
 ****************************************************************
@@ -1392,6 +1549,8 @@ VioWidget::VioWidget(QWidget* parent, VioStyle* config, bool alloc) :
 
 // destruct
 VioWidget::~VioWidget(void) {
+  // model/view are still alive: give lazy clients a last chance
+  if(mModel) mModel->AboutToChange();
 }
 
 // tell configuration
@@ -1520,6 +1679,14 @@ void VioWidget::Write(const QString& rFilename) {
   Modified(false);
 }
 
+// data snapshot: flush view and pass on to my model
+VioData* VioWidget::Data(void) {
+  // be sure that visual rep is in sync with model
+  if(mView->Modified()) mView->UpdateModel();
+  // get data
+  return mModel->Data();
+}
+
 // token io: pass through to my model
 void VioWidget::Read(faudes::TokenReader& rTr) {
   mModel->Read(rTr);
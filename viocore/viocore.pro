@@ -32,6 +32,7 @@ HEADERS      += $$VIODES_INCLUDE/viostyle.h \
                 $$VIODES_INCLUDE/viosymbol.h \ 
                 $$VIODES_INCLUDE/viotoken.h \ 
                 $$VIODES_INCLUDE/vioconsole.h \ 
+                $$VIODES_INCLUDE/violuapool.h \ 
                 $$VIODES_INCLUDE/viotypes.h \ 
                 $$VIODES_INCLUDE/vioregistry.h \ 
                 $$VIODES_INCLUDE/vioattrstyle.h \
@@ -45,6 +46,7 @@ SOURCES      += src/viostyle.cpp \
                 src/viosymbol.cpp \ 
                 src/viotoken.cpp \ 
                 src/vioconsole.cpp \ 
+                src/violuapool.cpp \ 
                 src/viotypes.cpp \
                 src/vioregistry.cpp \
                 src/vioattrstyle.cpp \
@@ -0,0 +1,362 @@
+/* vioautosave.cpp  - background autosave for vioedit windows */
+
+#include "vioautosave.h"
+
+// process lookup
+#ifdef Q_OS_WIN32
+#include <windows.h>
+#else
+#include <signal.h>
+#include <errno.h>
+#endif
+
+/*
+************************************************
+************************************************
+
+Implementation: VioAutoSaveWriter
+
+************************************************
+************************************************
+*/
+
+// construct
+VioAutoSaveWriter::VioAutoSaveWriter(QObject* parent, const QByteArray& buffer,
+  const QString& filename) :
+  QThread(parent),
+  mBuffer(buffer),
+  mFileName(filename)
+{
+}
+
+// destruct (callers thread)
+VioAutoSaveWriter::~VioAutoSaveWriter(void) {
+  wait();
+}
+
+// run (this is the thread itself, called by start()
+void VioAutoSaveWriter::run(void) {
+  FD_DQT("VioAutoSaveWriter::run(): " << VioStyle::StrFromQStr(mFileName));
+  mErrString="";
+  QString tmpname=mFileName+".tmp";
+  // write to temporary file (plain bytes, no faudes objects involved)
+  QFile tmpfile(tmpname);
+  if(!tmpfile.open(QIODevice::WriteOnly | QIODevice::Truncate)) 
+    mErrString="cannot open "+tmpname;
+  else if(tmpfile.write(mBuffer)!=mBuffer.size())
+    mErrString="cannot write "+tmpname;
+  tmpfile.close();
+  // replace target
+  if(mErrString=="") {
+    QFile::remove(mFileName);
+    if(!QFile::rename(tmpname,mFileName))
+      mErrString="cannot rename "+tmpname;
+  }
+  FD_DQT("VioAutoSaveWriter::run(): done");
+}
+
+
+/*
+************************************************
+************************************************
+
+Implementation: VioAutoSave
+
+************************************************
+************************************************
+*/
+
+// static: session counter
+int VioAutoSave::msSessionCount = 0;
+
+// construct
+VioAutoSave::VioAutoSave(QObject* parent) :
+  QObject(parent),
+  mStale(false),
+  mTicks(0),
+  mWriter(0)
+{
+  // append records every second
+  mFlushTimer = new QTimer(this);
+  mFlushTimer->setInterval(1000);
+  connect(mFlushTimer,SIGNAL(timeout()),this,SLOT(Flush()));
+  // consider a snapshot every ten seconds
+  mCompactTimer = new QTimer(this);
+  mCompactTimer->setInterval(10000);
+  connect(mCompactTimer,SIGNAL(timeout()),this,SLOT(Compact()));
+}
+
+// destruct
+VioAutoSave::~VioAutoSave(void) {
+  // wait for pending snapshot
+  if(mWriter) delete mWriter;
+  mWriter=0;
+  // flush journal (we keep files when the widget is still around)
+  Flush();
+}
+
+// static: autosave directory
+QString VioAutoSave::Directory(void) {
+  QString dir= QDesktopServices::storageLocation(QDesktopServices::DataLocation);
+  if(dir=="") dir=QDir::tempPath();
+  dir = dir + QDir::separator() + "autosave";
+  QDir().mkpath(dir);
+  return dir;
+}
+
+// static: file names
+QString VioAutoSave::FileName(const QString& session, const QString& suffix) {
+  return Directory() + QDir::separator() + session + "." + suffix;
+}
+
+// file names
+QString VioAutoSave::FileName(const QString& suffix) const {
+  return FileName(mSession,suffix);
+}
+
+// static: test whether a process is still running
+bool VioAutoSave::Alive(qint64 pid) {
+  if(pid<=0) return false;
+  if(pid==QCoreApplication::applicationPid()) return true;
+#ifdef Q_OS_WIN32
+  HANDLE proc=OpenProcess(PROCESS_QUERY_INFORMATION,FALSE,(DWORD) pid);
+  if(!proc) return false;
+  DWORD code=0;
+  bool res= GetExitCodeProcess(proc,&code) && code==STILL_ACTIVE;
+  CloseHandle(proc);
+  return res;
+#else
+  return kill((pid_t) pid,0)==0 || errno==EPERM;
+#endif
+}
+
+// static: list left-over sessions (excl sessions owned by a running process)
+QStringList VioAutoSave::Pending(void) {
+  QStringList res;
+  QStringList infos=QDir(Directory()).entryList(QStringList() << "vioedit_*.inf", QDir::Files, QDir::Time);
+  foreach(const QString& info, infos) {
+    QString session=QFileInfo(info).completeBaseName();
+    // session name is vioedit_<pid>_<count>
+    bool ok;
+    qint64 pid=session.section('_',1,1).toLongLong(&ok);
+    if(ok && Alive(pid)) continue;
+    res.append(session);
+  }
+  return res;
+}
+
+// static: remove session files
+void VioAutoSave::Discard(const QString& session) {
+  if(session=="") return;
+  QFile::remove(FileName(session,"jnl"));
+  QFile::remove(FileName(session,"jnl.1"));
+  QFile::remove(FileName(session,"vio"));
+  QFile::remove(FileName(session,"vio.tmp"));
+  QFile::remove(FileName(session,"inf"));
+}
+
+// static: append one file to another
+void VioAutoSave::AppendFile(const QString& src, const QString& dst) {
+  QFile sfile(src);
+  if(!sfile.open(QIODevice::ReadOnly)) return;
+  QFile dfile(dst);
+  if(!dfile.open(QIODevice::WriteOnly | QIODevice::Append)) return;
+  dfile.write(sfile.readAll());
+}
+
+// set widget to monitor
+void VioAutoSave::Widget(VioWidget* viowid) {
+  FD_DQT("VioAutoSave::Widget()");
+  // stop monitoring
+  mFlushTimer->stop();
+  mCompactTimer->stop();
+  if(mWriter) delete mWriter;
+  mWriter=0;
+  if(pVioWidget) {
+    disconnect(pVioWidget->Model(),0,this,0);
+    disconnect(pVioWidget,0,this,0);
+  }
+  // remove files
+  Discard(mSession);
+  mPending.clear();
+  mSession="";
+  mOrigin="";
+  mBase="";
+  pVioWidget=viowid;
+  if(!pVioWidget) return;
+  // set up new session
+  mSession=QString("vioedit_%1_%2").arg(QCoreApplication::applicationPid()).arg(++msSessionCount);
+  connect(pVioWidget->Model(),SIGNAL(NotifyJournal(const QByteArray&)),this,SLOT(Journal(const QByteArray&)));
+  connect(pVioWidget->Model(),SIGNAL(NotifyAnyChange()),this,SLOT(AnyChange()));
+  connect(pVioWidget,SIGNAL(NotifyModified(bool)),this,SLOT(AnyChange()));
+  // we dont know where the data came from: have a snapshot asap
+  mStale=true;
+  mTicks=6;
+  WriteInfo();
+  mFlushTimer->start();
+  mCompactTimer->start();
+}
+
+// set origin file
+void VioAutoSave::Origin(const QString& filename) {
+  mOrigin=filename;
+  // the origin is the base for recovery, unless we are busy with a snapshot
+  if(pVioWidget && filename!="" && !mWriter && !pVioWidget->Modified()) {
+    mPending.clear();
+    QFile::remove(FileName("jnl"));
+    QFile::remove(FileName("jnl.1"));
+    QFile::remove(FileName("vio"));
+    mBase=filename;
+    mStale=false;
+  }
+  WriteInfo();
+}
+
+// write session info
+void VioAutoSave::WriteInfo(void) {
+  if(!pVioWidget) return;
+  QFile info(FileName("inf"));
+  if(!info.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) return;
+  QTextStream ts(&info);
+  ts << pVioWidget->FaudesType() << "\n" << mOrigin << "\n" << mBase << "\n";
+}
+
+// record journal entry
+void VioAutoSave::Journal(const QByteArray& rRecord) {
+  // empty records indicate a change not covered by the journal
+  if(rRecord.isEmpty()) mStale=true;
+  mPending.append(rRecord);
+}
+
+// record any change
+void VioAutoSave::AnyChange(void) {
+  if(!pVioWidget) return;
+  if(!pVioWidget->Model()->JournalSupported()) mStale=true;
+}
+
+// append pending records to journal
+void VioAutoSave::Flush(void) {
+  if(mPending.isEmpty()) return;
+  if(mSession=="") return;
+  QFile jnl(FileName("jnl"));
+  if(!jnl.open(QIODevice::WriteOnly | QIODevice::Append)) {
+    FD_WARN("VioAutoSave::Flush(): cannot open journal");
+    mPending.clear();
+    mStale=true;
+    return;
+  }
+  QDataStream out(&jnl);
+  out.setVersion(QDataStream::Qt_4_4);
+  foreach(const QByteArray& record, mPending)
+    out << record;
+  mPending.clear();
+}
+
+// compact snapshot
+void VioAutoSave::Compact(void) {
+  if(!pVioWidget) return;
+  if(mWriter) return;
+  // figure whether a snapshot is due: the journal covers all 
+  // changes unless stale, so we copy the data at most once a minute 
+  mTicks++;
+  if(!mStale) return;
+  if(mTicks < 6) return;
+  FD_DQT("VioAutoSave::Compact()");
+  // rotate journal (if the previous snapshot failed, we keep the old journal)
+  Flush();
+  QString jnl=FileName("jnl");
+  QString jnl1=FileName("jnl.1");
+  if(QFile::exists(jnl1)) {
+    AppendFile(jnl,jnl1);
+    QFile::remove(jnl);
+  } else {
+    QFile::rename(jnl,jnl1);
+  }
+  // serialise here (faudes is not thread safe), write file in separate thread
+  QByteArray buffer;
+  try {
+    faudes::TokenWriter tw(faudes::TokenWriter::String);
+    pVioWidget->Write(tw);
+    buffer=QByteArray(tw.Str().c_str());
+  } catch(faudes::Exception& fexcep) {
+    FD_WARN("VioAutoSave::Compact(): " << fexcep.What());
+    mTicks=0;
+    return;
+  }
+  mWriter= new VioAutoSaveWriter(this,buffer,FileName("vio"));
+  connect(mWriter,SIGNAL(finished()),this,SLOT(CompactDone()));
+  mStale=false;
+  mTicks=0;
+  mWriter->start(QThread::LowPriority);
+}
+
+// complete compaction
+void VioAutoSave::CompactDone(void) {
+  if(!mWriter) return;
+  if(mWriter->isRunning()) return;
+  FD_DQT("VioAutoSave::CompactDone()");
+  // on success, the snapshot covers the rotated journal
+  if(mWriter->ErrString()=="") {
+    QFile::remove(FileName("jnl.1"));
+    mBase="";
+    WriteInfo();
+  } else {
+    FD_WARN("VioAutoSave::CompactDone(): " << VioStyle::StrFromQStr(mWriter->ErrString()));
+    mStale=true;
+  }
+  mWriter->deleteLater();
+  mWriter=0;
+}
+
+// static: recover session
+VioWidget* VioAutoSave::Recover(const QString& session, QString& rOrigin, bool& rComplete) {
+  FD_DQT("VioAutoSave::Recover(): " << VioStyle::StrFromQStr(session));
+  rComplete=true;
+  // read session info
+  QFile info(FileName(session,"inf"));
+  if(!info.open(QIODevice::ReadOnly | QIODevice::Text))
+    throw faudes::Exception("VioAutoSave::Recover", "cannot read session info", 1);
+  QTextStream ts(&info);
+  QString ftype=ts.readLine();
+  rOrigin=ts.readLine();
+  QString base=ts.readLine();
+  // have a model
+  VioModel* model=VioTypeRegistry::NewModel(ftype);
+  if(!model)
+    throw faudes::Exception("VioAutoSave::Recover", "unknown type "+VioStyle::StrFromQStr(ftype), 1);
+  try {
+    // read snapshot
+    QString snapname=FileName(session,"vio");
+    if(QFile::exists(snapname)) {
+      model->Read(snapname);
+    }
+    // or read origin file
+    else if(base!="") {
+      model->Read(base);
+    }
+    // replay journal
+    QStringList jnls;
+    jnls << FileName(session,"jnl.1") << FileName(session,"jnl");
+    foreach(const QString& jnlname, jnls) {
+      QFile jnl(jnlname);
+      if(!jnl.open(QIODevice::ReadOnly)) continue;
+      QDataStream in(&jnl);
+      in.setVersion(QDataStream::Qt_4_4);
+      while(rComplete && !in.atEnd()) {
+        QByteArray record;
+        in >> record;
+        if(in.status()!=QDataStream::Ok) { rComplete=false; break; }
+        if(model->JournalReplay(record)!=0) rComplete=false;
+      }
+    }
+  } catch(faudes::Exception&) {
+    delete model;
+    throw;
+  }
+  // have a widget
+  VioWidget* viowid=VioTypeRegistry::NewWidget(ftype);
+  viowid->Model(model);
+  viowid->Modified(true);
+  FD_DQT("VioAutoSave::Recover(): done");
+  return viowid;
+}
@@ -0,0 +1,170 @@
+/* vioautosave.h  - background autosave for vioedit windows */
+
+
+#ifndef FAUDES_VIOAUTOSAVE_H
+#define FAUDES_VIOAUTOSAVE_H
+
+#include <QApplication>
+#include <QtGui>
+#include "libviodes.h"
+
+
+/*
+************************************************
+************************************************
+
+A VioAutoSaveWriter writes a data snapshot to file in
+a separate thread. The snapshot is passed as a buffer that
+has been serialised by the caller, so the thread does not 
+touch any faudes objects. The file is written to a temporary 
+location and renamed when complete.
+
+************************************************
+************************************************
+*/
+
+class VioAutoSaveWriter : public QThread {
+
+ Q_OBJECT
+
+public:
+
+  // construct/destruct
+  VioAutoSaveWriter(QObject* parent, const QByteArray& buffer, 
+    const QString& filename);
+  ~VioAutoSaveWriter(void);
+
+  // get parameter
+  const QString& FileName(void) const { return mFileName; };
+  const QString& ErrString(void) const { return mErrString; };
+
+private:
+
+  // start() thread calls run
+  void run(void);
+
+  // data to write
+  QByteArray mBuffer;
+  QString mFileName;
+  QString mErrString;
+};
+
+
+/*
+************************************************
+************************************************
+
+A VioAutoSave monitors a VioWidget and maintains
+a recovery copy of its data. The recovery copy consists
+of a snapshot and a journal of compact change records
+as emitted by VioModel::NotifyJournal(). Records are
+appended to the journal by a timer. As long as the
+journal covers all changes, no snapshot is taken; the
+journal is reset when the document is saved. Changes
+not covered, e.g. by models that do not support the
+journal, trigger a compaction at most once a minute:
+the journal is rotated, the model is written to a buffer
+in vio format incl. representation data, and the buffer
+is written to file by a VioAutoSaveWriter. Thus, no file 
+io takes place on the users edit operations.
+
+On crash recovery, the snapshot (or the origin file if
+there is no snapshot) is read and the journal is replayed
+up to the first record that has not been journaled.
+Sessions are named after the process id, and sessions
+of running processes are not considered left-over.
+
+************************************************
+************************************************
+*/
+
+class VioAutoSave : public QObject {
+
+ Q_OBJECT
+
+public:
+
+  // construct/destruct
+  VioAutoSave(QObject* parent=0);
+  ~VioAutoSave(void);
+
+  // set widget to monitor (we dont take ownership; 0 to stop and remove files)
+  void Widget(VioWidget* viowid);
+
+  // set origin file (i.e. the document was just saved or loaded)
+  void Origin(const QString& filename);
+
+  // static: autosave directory
+  static QString Directory(void);
+
+  // static: list left-over sessions (excl sessions of running processes)
+  static QStringList Pending(void);
+
+  // static: recover session (faudes exception on error, set flag on incomplete journal)
+  static VioWidget* Recover(const QString& session, QString& rOrigin, bool& rComplete);
+
+  // static: remove session files
+  static void Discard(const QString& session);
+
+public slots:
+
+  // record journal entry
+  void Journal(const QByteArray& rRecord);
+
+  // record change that may not be journaled
+  void AnyChange(void);
+
+  // append pending records to journal
+  void Flush(void);
+
+  // compact snapshot
+  void Compact(void);
+
+private slots:
+
+  // complete compaction
+  void CompactDone(void);
+
+private:
+
+  // helper: session file names
+  QString FileName(const QString& suffix) const;
+  static QString FileName(const QString& session, const QString& suffix);
+
+  // helper: write session info
+  void WriteInfo(void);
+
+  // helper: append one journal file to another
+  static void AppendFile(const QString& src, const QString& dst);
+
+  // helper: test whether a process is running
+  static bool Alive(qint64 pid);
+
+  // monitored widget
+  QPointer<VioWidget> pVioWidget;
+
+  // session name, origin file and base file for recovery
+  QString mSession;
+  QString mOrigin;
+  QString mBase;
+
+  // pending records
+  QList<QByteArray> mPending;
+
+  // state: there is a change not covered by the journal
+  bool mStale;
+  int mTicks;
+
+  // timers
+  QTimer* mFlushTimer;
+  QTimer* mCompactTimer;
+
+  // compaction in progress
+  VioAutoSaveWriter* mWriter;
+
+  // session counter
+  static int msSessionCount;
+
+};
+
+#endif
@@ -0,0 +1,237 @@
+/* viobatch.cpp  - batch conversion/export for vioedit */
+
+#include "viobatch.h"
+
+/*
+************************************************
+************************************************
+
+Implementation: VioBatch
+
+************************************************
+************************************************
+*/
+
+// construct
+VioBatch::VioBatch(void) :
+  mType("System"),
+  mOutDir(""),
+  mLayout(false),
+  mJobs(1),
+  mDefinition(""),
+  mVariant(0)
+{
+  mFormats << "svg";
+}
+
+// usage
+QString VioBatch::Usage(void) {
+  return
+    "usage: vioedit -b [-c config.txt] [-j jobs] [-l] [-t type] [-o outdir] [-f svg,pdf,png,vio] file ...\n"
+    "       vioedit -b [-c config.txt] -e definition.rti [-v variant] file ...";
+}
+
+// parse command line (ret 0 on success)
+int VioBatch::Arguments(const QStringList& args) {
+  // expect -b as first argument
+  if(args.size()<2) return 1;
+  if(args.at(1)!="-b") return 1;
+  // options
+  int i=2;
+  for(; i<args.size(); i++) {
+    const QString& opt=args.at(i);
+    if(!opt.startsWith("-")) break;
+    if(opt=="-l") { mLayout=true; continue; }
+    if(i+1>=args.size()) return 1;
+    const QString& val=args.at(++i);
+    if(opt=="-c") { mConfigFile=val; continue; }
+    if(opt=="-t") { mType=val; continue; }
+    if(opt=="-o") { mOutDir=val; continue; }
+    if(opt=="-f") { mFormats=val.toLower().split(",",QString::SkipEmptyParts); continue; }
+    if(opt=="-e") { mDefinition=val; continue; }
+    if(opt=="-v") {
+      bool ok;
+      mVariant=val.toInt(&ok);
+      if(!ok || mVariant<0) return 1;
+      continue;
+    }
+    if(opt=="-j") {
+      bool ok;
+      mJobs=val.toInt(&ok);
+      if(!ok || mJobs<1) return 1;
+      continue;
+    }
+    return 1;
+  }
+  // files
+  for(; i<args.size(); i++)
+    mFiles.append(args.at(i));
+  if(mFiles.size()==0 && mDefinition=="") return 1;
+  if(mFormats.size()==0) return 1;
+  return 0;
+}
+
+// run the batch (ret 0 on success)
+int VioBatch::Run(void) {
+  // evaluate lua function
+  if(mDefinition!="") return Evaluate();
+  // distribute to workers
+  if(mJobs>1 && mFiles.size()>1) return RunWorkers();
+  // do it here
+  int res=0;
+  QTime total;
+  total.start();
+  foreach(const QString& filename, mFiles)
+    if(Process(filename)!=0) res=1;
+  std::cout << "vioedit: processed " << mFiles.size() << " files in " << total.elapsed() << " ms" << std::endl;
+  return res;
+}
+
+
+// distribute to worker processes (ret 0 on success)
+int VioBatch::RunWorkers(void) {
+  // common arguments
+  QStringList args;
+  args << "-b";
+  if(mConfigFile!="") args << "-c" << mConfigFile;
+  if(mLayout) args << "-l";
+  args << "-t" << mType;
+  if(mOutDir!="") args << "-o" << mOutDir;
+  args << "-f" << mFormats.join(",");
+  // distribute files
+  int jobs=qMin(mJobs,mFiles.size());
+  QList<QStringList> jobfiles;
+  for(int j=0; j<jobs; j++) jobfiles.append(QStringList());
+  for(int i=0; i<mFiles.size(); i++) jobfiles[i % jobs].append(mFiles.at(i));
+  // start workers
+  QTime total;
+  total.start();
+  QList<QProcess*> workers;
+  for(int j=0; j<jobs; j++) {
+    QProcess* worker = new QProcess();
+    worker->setProcessChannelMode(QProcess::ForwardedChannels);
+    worker->start(QCoreApplication::applicationFilePath(), args + jobfiles.at(j));
+    workers.append(worker);
+  }
+  // wait for workers
+  int res=0;
+  foreach(QProcess* worker, workers) {
+    worker->waitForFinished(-1);
+    if(worker->exitStatus()!=QProcess::NormalExit || worker->exitCode()!=0) res=1;
+    delete worker;
+  }
+  std::cout << "vioedit: processed " << mFiles.size() << " files with " << jobs <<
+    " jobs in " << total.elapsed() << " ms" << std::endl;
+  return res;
+}
+
+
+// process one file (ret 0 on success)
+int VioBatch::Process(const QString& filename) {
+  QTime time;
+  time.start();
+  QString err="";
+  VioModel* model=0;
+  // read file
+  try {
+    if(QFileInfo(filename).suffix()=="vio") {
+      // figure type from first token
+      faudes::TokenReader tr(VioStyle::LfnFromQStr(filename));
+      faudes::Token token;
+      tr.Peek(token);
+      QString ftype=VioStyle::QStrFromStr(token.StringValue());
+      if(ftype.startsWith("Vio")) ftype.remove(0,3);
+      model=VioTypeRegistry::NewModel(ftype);
+      if(!model) err=QString("unknown type \"%1\"").arg(ftype);
+      else model->Read(tr);
+    } else {
+      model=VioTypeRegistry::NewModel(mType);
+      if(!model) err=QString("unknown type \"%1\"").arg(mType);
+      else model->ImportFaudesFile(filename);
+    }
+  } catch(faudes::Exception& fexcep) {
+    err=VioStyle::QStrFromStr(fexcep.What());
+  }
+  int tread=time.elapsed();
+  // layout
+  if(err=="" && mLayout) {
+    if(model->AutoLayout()!=0) err="layout failed";
+  }
+  int tlayout=time.elapsed();
+  // export
+  QString base=QFileInfo(filename).completeBaseName();
+  QString dir=mOutDir;
+  if(dir=="") dir=QFileInfo(filename).absolutePath();
+  if(err=="") foreach(const QString& format, mFormats) {
+    QString outname=dir + QDir::separator() + base + "." + format;
+    try {
+      if(format=="vio") model->Write(outname);
+      else if(format=="gen") model->ExportFaudesFile(outname);
+      else if(model->ExportGraphics(outname)!=0)
+        err=QString("cannot export %1").arg(outname);
+    } catch(faudes::Exception& fexcep) {
+      err=VioStyle::QStrFromStr(fexcep.What());
+    }
+    if(err!="") break;
+  }
+  int texport=time.elapsed();
+  // report
+  if(model) delete model;
+  if(err!="") {
+    std::cout << VioStyle::StrFromQStr(filename) << ": error: " << VioStyle::StrFromQStr(err) << std::endl;
+    return 1;
+  }
+  std::cout << VioStyle::StrFromQStr(filename) << ": ok: read " << tread << " ms, layout " <<
+    tlayout-tread << " ms, export " << texport-tlayout << " ms" << std::endl;
+  return 0;
+}
+
+
+// evaluate lua function on one argument binding (ret 0 on success)
+int VioBatch::Evaluate(void) {
+  QTime time;
+  time.start();
+  QString err="";
+  faudes::LuaFunctionDefinition* lfdef=0;
+  faudes::Function* fnct=0;
+  QList<faudes::Type*> params;
+  try {
+    // read definition and set up function 
+    lfdef = new faudes::LuaFunctionDefinition();
+    lfdef->Read(VioStyle::LfnFromQStr(mDefinition));
+    fnct = lfdef->NewFunction();
+    fnct->Variant(mVariant);
+    const faudes::Signature* sig = fnct->Variant();
+    if(!sig || sig->Size()!=mFiles.size())
+      throw faudes::Exception("VioBatch::Evaluate", "parameter mismatch", 47);
+    // read arguments
+    for(int i=0; i<sig->Size(); i++) {
+      const faudes::Parameter& par = sig->At(i);
+      faudes::Type* fobject = faudes::TypeRegistry::G()->NewObject(par.Type());
+      params.append(fobject);
+      if(par.Attribute()!=faudes::Parameter::Out)
+        fobject->Read(VioStyle::LfnFromQStr(mFiles.at(i)));
+      fnct->ParamValue(i,fobject);
+    }
+    // execute
+    fnct->Execute();
+    // write results
+    for(int i=0; i<sig->Size(); i++) {
+      if(sig->At(i).Attribute()==faudes::Parameter::In) continue;
+      params.at(i)->Write(VioStyle::LfnFromQStr(mFiles.at(i)));
+    }
+  } catch(faudes::Exception& fexcep) {
+    err=VioStyle::QStrFromStr(fexcep.What());
+  }
+  // clean up
+  if(fnct) delete fnct;
+  if(lfdef) delete lfdef;
+  qDeleteAll(params);
+  // report in one line
+  if(err!="") {
+    std::cout << "evaluate: error: " << VioStyle::StrFromQStr(err.simplified()) << std::endl;
+    return 1;
+  }
+  std::cout << "evaluate: ok: " << time.elapsed() << " ms" << std::endl;
+  return 0;
+}
@@ -0,0 +1,85 @@
+/* viobatch.h  - batch conversion/export for vioedit */
+
+
+#ifndef FAUDES_VIOBATCH_H
+#define FAUDES_VIOBATCH_H
+
+#include <QApplication>
+#include <QtGui>
+#include "libviodes.h"
+
+
+/*
+************************************************
+************************************************
+
+A VioBatch processes a list of files without user
+interaction: each file is read (.vio or faudes format),
+optionally layouted and exported to the specified
+formats (svg, pdf, eps, png, jpg, vio, gen). Errors and
+timings are reported per file on stdout. With more than
+one job, the file list is distributed to worker processes,
+i.e., vioedit is invoked recursively.
+
+  vioedit -b [-c config] [-j jobs] [-l] [-t type] [-o dir] [-f formats] files
+
+With -e, the files are one argument binding to a lua
+function definition, one file per parameter of the
+specified variant. In and InOut parameters are read
+from the respective file, Out and InOut parameters are 
+written back after execution. The result is reported as
+one line "evaluate: ok: <time> ms" or "evaluate: error: 
+<message>". This serves as worker process for the batch 
+evaluation of lua functions.
+
+  vioedit -b [-c config] -e definition [-v variant] files
+
+************************************************
+************************************************
+*/
+
+class VioBatch {
+
+public:
+
+  // construct/destruct
+  VioBatch(void);
+
+  // parse command line (ret 0 on success)
+  int Arguments(const QStringList& args);
+
+  // get parameter
+  const QString& ConfigFile(void) const { return mConfigFile; };
+  bool Layout(void) const { return mLayout; };
+
+  // run the batch (ret 0 on success)
+  int Run(void);
+
+  // usage string
+  static QString Usage(void);
+
+private:
+
+  // process one file (ret 0 on success)
+  int Process(const QString& filename);
+
+  // distribute to worker processes (ret 0 on success)
+  int RunWorkers(void);
+
+  // evaluate lua function (ret 0 on success)
+  int Evaluate(void);
+
+  // options
+  QString mConfigFile;
+  QString mType;
+  QString mOutDir;
+  QStringList mFormats;
+  QStringList mFiles;
+  bool mLayout;
+  int mJobs;
+  QString mDefinition;
+  int mVariant;
+
+};
+
+#endif
@@ -19,7 +19,8 @@ QMainWindow* VioWindow::spConsole = NULL;
 // construct
 VioWindow::VioWindow() : 
   QMainWindow(0),
-  mVioWidget(0) 
+  mVioWidget(0),
+  mAutoSave(0)
 {
 
   // have one console
@@ -34,6 +35,9 @@ VioWindow::VioWindow() :
   setAttribute(Qt::WA_DeleteOnClose);
   setContentsMargins(0,0,0,0);
 
+  // have autosave
+  mAutoSave = new VioAutoSave(this);
+
   // have empty vio widget to start with
   VioWidget* viowid = VioTypeRegistry::NewWidget("System");
   if(!viowid) { // todo: slot for fatal error
@@ -69,11 +73,13 @@ VioWindow::VioWindow() :
 // set vio widget  (incl deleting current widget)
 void VioWindow::Widget(VioWidget* viowid) {
   // disconnect old, delete old
+  mAutoSave->Widget(0);
   if(mVioWidget) {
     delete mVioWidget;
   }
   // take it
   mVioWidget=viowid;
+  mAutoSave->Widget(mVioWidget);
   mVioWidget->setParent(this);
   setCentralWidget(mVioWidget);
   // connect it
@@ -755,6 +761,7 @@ void VioWindow::LoadFile(const QString &fileName) {
 
   // read ok
   CurrentFile(fileName);
+  mAutoSave->Origin(mCurrentFile);
   statusBar()->showMessage(tr("File loaded"), 2000);
 }
 
@@ -787,6 +794,7 @@ void VioWindow::SaveFile(const QString &fileName) {
   
   // record filename
   CurrentFile(fileName);
+  mAutoSave->Origin(mCurrentFile);
   statusBar()->showMessage(tr("File saved"), 2000);
 }
 
@@ -912,6 +920,9 @@ void VioWindow::closeEvent ( QCloseEvent * event ){
   QSettings settings("Faudes", "vioDiag");
   settings.setValue("geometry", saveGeometry());
 
+  // no more recovery copy
+  mAutoSave->Widget(0);
+
   // call base
   QMainWindow::closeEvent(event);
 }
@@ -966,8 +977,62 @@ Implementation: main()
 */
 
 
+// batch mode: no windows, report to stdout
+int BatchMain(int argc, char *argv[], const QStringList& args) {
+
+  // parse commandline
+  VioBatch batch;
+  if(batch.Arguments(args)!=0) {
+    std::cout << VioStyle::StrFromQStr(VioBatch::Usage()) << std::endl;  
+    return 1;
+  }
+
+  // without display, we run without gui (the dot layout uses a progress dialog)
+  bool gui=true;
+#ifdef Q_WS_X11
+  if(qgetenv("DISPLAY").isEmpty()) gui=false;
+#endif
+  if(!gui && batch.Layout()) {
+    std::cout << "vioedit: layout requires a display" << std::endl;  
+    return 1;
+  }
+
+  // let Qt see commandline
+  QApplication app(argc, argv, gui);
+  QApplication::addLibraryPath(QCoreApplication::applicationDirPath() + QDir::separator()+ "plugins"); 
+
+  // configure
+  VioStyle::Initialise();
+  QString cfgname=batch.ConfigFile();
+  if(cfgname=="") {
+    cfgname =  QCoreApplication::applicationDirPath() + "/vioconfig.txt";
+    if(!QFile::exists(cfgname)) cfgname="";
+  }
+  try { 
+    if(cfgname!="") VioStyle::ReadFile(cfgname); 
+    QString rtifile = QCoreApplication::applicationDirPath() + QDir::separator()+ "libfaudes.rti"; 
+    faudes::LoadRegistry(VioStyle::StrFromQStr(rtifile));
+    VioTypeRegistry::Initialise();
+  } catch (faudes::Exception& fexcep) {
+    std::cout << "vioedit: " << fexcep.What() << std::endl;  
+    return 1;
+  }
+
+  // doit
+  return batch.Run();
+}
+
+
 int main(int argc, char *argv[]) {
 
+  // batch mode
+  if(argc>1) 
+  if(QString(argv[1])=="-b") {
+    QStringList args;
+    for(int i=0; i<argc; i++) args << QString::fromLocal8Bit(argv[i]);
+    return BatchMain(argc,argv,args);
+  }
+
   // let Qt see commandline
   QApplication app(argc, argv);
  
@@ -1026,6 +1091,7 @@ int main(int argc, char *argv[]) {
   // report error
   if(!ok) {
     std::cout << "usage: viodiag [-c config.txt] [generator.vio]" << std::endl;  
+    std::cout << "       " << VioStyle::StrFromQStr(VioBatch::Usage()) << std::endl;  
     return 1;
   }
 
@@ -1108,10 +1174,43 @@ int main(int argc, char *argv[]) {
     exit(1);
   }
 
+  // recover from autosave
+  FD_WARN("viodiag: test for recovery files");
+  QSettings settings("Faudes", "vioDiag");
+  foreach(const QString& session, VioAutoSave::Pending()) {
+    int ret = QMessageBox::warning(0, 
+      "vioDiag",
+      "<p>vioDiag found unsaved changes from a previous session.</p>"
+      "<p>Do you want to recover the document?</p>",
+      QMessageBox::Yes | QMessageBox::Discard | QMessageBox::Ignore, 
+      QMessageBox::Yes);
+    if(ret == QMessageBox::Ignore) continue;
+    if(ret == QMessageBox::Yes) {
+      QString origin;
+      bool complete=true;
+      VioWidget* viowid=0;
+      try { 
+        viowid = VioAutoSave::Recover(session,origin,complete);
+      } catch (faudes::Exception& fexcep) {
+        QString err=QString("Error: ")+VioStyle::QStrFromStr(fexcep.What());
+        QMessageBox::warning(0,"vioDiag",
+          QString("<p>Cannot recover document.</p><p>%1</p>").arg(err));
+        continue;
+      }
+      if(!complete) 
+        QMessageBox::warning(0,"vioDiag",
+          QString("<p>Recovered document %1 may lack the most recent changes.</p>").arg(origin));
+      VioWindow* rwin = new VioWindow();
+      rwin->Widget(viowid);
+      rwin->restoreGeometry(settings.value("geometry").toByteArray());
+      rwin->show();
+    }
+    VioAutoSave::Discard(session);
+  }
+
   // load file and go
   FD_WARN("viodiag: open main window");
   VioWindow *vioWin = new VioWindow;
-  QSettings settings("Faudes", "vioDiag");
   vioWin->restoreGeometry(settings.value("geometry").toByteArray());
   if(vioname!="") vioWin->LoadFile(vioname);
   vioWin->show();
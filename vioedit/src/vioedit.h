@@ -7,6 +7,8 @@
 #include <QApplication>
 #include <QtGui>
 #include "libviodes.h"
+#include "vioautosave.h"
+#include "viobatch.h"
 
 
 /*
@@ -100,6 +102,9 @@ private:
   // central widget (changes on new or open)
   VioWidget* mVioWidget;
 
+  // recovery copy of central widget
+  VioAutoSave* mAutoSave;
+
   // my menues
   QMenu *mFileMenu;
   QMenu *mNewMenu;
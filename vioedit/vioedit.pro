@@ -35,8 +35,8 @@ MOC_DIR = ./obj
 
 
 # vioedit sources
-HEADERS      += src/vioedit.h                 
-SOURCES      += src/vioedit.cpp
+HEADERS      += src/vioedit.h src/vioautosave.h src/viobatch.h
+SOURCES      += src/vioedit.cpp src/vioautosave.cpp src/viobatch.cpp
 
 # application icon
 ICON = ./images/icon_osx.icns 